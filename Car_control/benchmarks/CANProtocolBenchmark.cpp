@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include "CANProtocol.hpp"
+
+/********************************/
+/*   CAN PROTOCOL BENCHMARKS    */
+/********************************/
+
+// What sendDrivingCommand() does before write()
+static void	BM_PackDrivingCommand(benchmark::State &state) {
+
+	int16_t	throttle = -100;
+	int16_t	steering = 0;
+
+	for (auto _ : state) {
+		uint8_t	data[8] = {};
+		CANMSG::DRIVING_COMMAND::pack(data, {throttle, steering});
+		benchmark::DoNotOptimize(data);
+		throttle = static_cast<int16_t>(throttle == 100 ? -100 : throttle + 10);
+		steering = static_cast<int16_t>(steering == 180 ? 0 : steering + 2);
+	}
+}
+BENCHMARK(BM_PackDrivingCommand);
+
+// Runtime path of the prebuilt brake frames, for reference
+static void	BM_MakeEmergencyBrakeFrame(benchmark::State &state) {
+
+	bool	active = false;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(active);
+		struct can_frame	frame = CANProtocol::makeEmergencyBrakeFrame(active);
+		benchmark::DoNotOptimize(frame);
+		active = !active;
+	}
+}
+BENCHMARK(BM_MakeEmergencyBrakeFrame);
+
+static void	BM_UnpackSpeed(benchmark::State &state) {
+
+	uint8_t	data[8] = {0x12, 0x34};
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(data);
+		benchmark::DoNotOptimize(CANMSG::SPEED::unpack(data));
+		data[0]++;
+	}
+}
+BENCHMARK(BM_UnpackSpeed);
+
+static void	BM_UnpackBattery(benchmark::State &state) {
+
+	uint8_t	data[8] = {0x00, 0x55, 0x0C};
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(data);
+		benchmark::DoNotOptimize(CANMSG::BATTERY::unpack(data));
+		data[0]++;
+	}
+}
+BENCHMARK(BM_UnpackBattery);
@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+#include "carControl.h"
+
+/********************************/
+/*     JOYSTICK BENCHMARKS      */
+/********************************/
+
+// Range of the evdev axes of the controller
+#define AXIS_MIN	0
+#define AXIS_MAX	1023
+
+// Math of Joystick::getAbs() once libevdev returned the raw value
+static void	BM_ScaleAxis(benchmark::State &state) {
+
+	const t_axisScale	scale = makeAxisScale(static_cast<int>(state.range(0)), AXIS_MIN, AXIS_MAX);
+	int32_t				value = AXIS_MIN;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(scaleAxis(scale, value));
+		value = value == AXIS_MAX ? AXIS_MIN : value + 1;
+	}
+}
+BENCHMARK(BM_ScaleAxis)->Arg(ABS_Z)->Arg(ABS_Y);
+
+// Done once per device, when the absinfo is read
+static void	BM_MakeAxisScale(benchmark::State &state) {
+
+	int32_t	maximum = AXIS_MAX;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(maximum);
+		benchmark::DoNotOptimize(makeAxisScale(ABS_Y, AXIS_MIN, maximum));
+	}
+}
+BENCHMARK(BM_MakeAxisScale);
+
+// Every scaled pair goes through stableValues() before being sent
+static void	BM_StableValues(benchmark::State &state) {
+
+	int16_t	rawSteering = 0;
+	int16_t	rawThrottle = -100;
+
+	for (auto _ : state) {
+		int16_t	steering = rawSteering;
+		int16_t	throttle = rawThrottle;
+		stableValues(&steering, &throttle);
+		benchmark::DoNotOptimize(steering);
+		benchmark::DoNotOptimize(throttle);
+		rawSteering = static_cast<int16_t>(rawSteering == 180 ? 0 : rawSteering + 1);
+		rawThrottle = static_cast<int16_t>(rawThrottle == 100 ? -100 : rawThrottle + 1);
+	}
+}
+BENCHMARK(BM_StableValues);
@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+#include "carControl.h"
+
+/********************************/
+/*   CAN RECEIVER BENCHMARKS    */
+/********************************/
+
+static int64_t	realtimeNs() {
+
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec);
+}
+
+static struct can_frame	speedFrame(uint16_t rpm) {
+
+	struct can_frame	frame = {};
+
+	frame.can_id = CANMSG::SPEED::ID;
+	frame.can_dlc = CANMSG::SPEED::DLC;
+	CANMSG::SPEED::pack(frame.data, {rpm});
+	return (frame);
+}
+
+static struct can_frame	batteryFrame(uint8_t percentage) {
+
+	struct can_frame	frame = {};
+
+	frame.can_id = CANMSG::BATTERY::ID;
+	frame.can_dlc = CANMSG::BATTERY::DLC;
+	CANMSG::BATTERY::pack(frame.data, {percentage, 12});
+	return (frame);
+}
+
+// What canReceiverThread does with each recvmmsg() batch, speed and battery interleaved
+static void	BM_DispatchRxBatch(benchmark::State &state) {
+
+	auto			receiver = std::make_unique<t_CANReceiver>();
+	auto			batch = std::make_unique<t_canRxBatch>();
+	int				count = static_cast<int>(state.range(0));
+	int64_t			now = realtimeNs();
+
+	receiver->can = nullptr;
+	registerReceiverHandlers(receiver.get());
+	can_rx_batch_init(batch.get());
+	for (int i = 0; i < count; i++) {
+		batch->frames[i] = i % 2 ? batteryFrame(static_cast<uint8_t>(i)) : speedFrame(static_cast<uint16_t>(i));
+		batch->timestampsNs[i] = now - (count - i) * 1000;
+	}
+
+	// No queue consumer, only the mailboxes are fed like in the car
+	for (auto _ : state)
+		dispatchRxBatch(receiver.get(), batch.get(), count);
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DispatchRxBatch)->Arg(1)->Arg(8)->Arg(CAN_RX_BATCH_SIZE);
+
+static t_CANReceiver	*g_receiver = nullptr;
+
+static void	setupShared(benchmark::State &state, bool queueSamples) {
+
+	if (state.thread_index() != 0)
+		return ;
+	g_receiver = new t_CANReceiver();
+	g_receiver->can = nullptr;
+	g_receiver->queueSamples = queueSamples;
+	registerReceiverHandlers(g_receiver);
+}
+
+static void	teardownShared(benchmark::State &state) {
+
+	if (state.thread_index() != 0)
+		return ;
+	delete g_receiver;
+	g_receiver = nullptr;
+}
+
+// Thread 0 decodes frames like canReceiverThread, thread 1 is the queue consumer
+static void	BM_SpeedQueueContention(benchmark::State &state) {
+
+	setupShared(state, true);
+	if (state.thread_index() == 0) {
+		struct can_frame	frame = speedFrame(1000);
+		for (auto _ : state)
+			g_receiver->dispatcher.dispatch(frame, 1);
+	} else {
+		t_speedData	data;
+		uint64_t	popped = 0;
+		for (auto _ : state)
+			popped += getSpeedData(g_receiver, &data);
+		state.counters["popped"] = static_cast<double>(popped);
+	}
+	state.SetItemsProcessed(state.iterations());
+	teardownShared(state);
+}
+BENCHMARK(BM_SpeedQueueContention)->Threads(2)->UseRealTime();
+
+static void	BM_BatteryQueueContention(benchmark::State &state) {
+
+	setupShared(state, true);
+	if (state.thread_index() == 0) {
+		struct can_frame	frame = batteryFrame(80);
+		for (auto _ : state)
+			g_receiver->dispatcher.dispatch(frame, 1);
+	} else {
+		t_batteryData	data;
+		uint64_t		popped = 0;
+		for (auto _ : state)
+			popped += getBatteryData(g_receiver, &data);
+		state.counters["popped"] = static_cast<double>(popped);
+	}
+	state.SetItemsProcessed(state.iterations());
+	teardownShared(state);
+}
+BENCHMARK(BM_BatteryQueueContention)->Threads(2)->UseRealTime();
+
+// Latest value readers (monitor, dashboard) racing the publisher
+static void	BM_LatestSpeedContention(benchmark::State &state) {
+
+	setupShared(state, false);
+	if (state.thread_index() == 0) {
+		struct can_frame	frame = speedFrame(1000);
+		for (auto _ : state)
+			g_receiver->dispatcher.dispatch(frame, 1);
+	} else {
+		t_speedSample	sample;
+		uint64_t		sequence = 0;
+		uint64_t		fresh = 0;
+		for (auto _ : state)
+			fresh += getLatestSpeed(g_receiver, &sample, &sequence);
+		state.counters["fresh"] = static_cast<double>(fresh);
+	}
+	state.SetItemsProcessed(state.iterations());
+	teardownShared(state);
+}
+BENCHMARK(BM_LatestSpeedContention)->Threads(2)->Threads(4)->UseRealTime();
+
+static void	BM_RpmToSpeedMps(benchmark::State &state) {
+
+	uint16_t	rpm = 0;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(rpmToSpeedMps(rpm));
+		rpm = static_cast<uint16_t>(rpm + 7);
+	}
+}
+BENCHMARK(BM_RpmToSpeedMps);
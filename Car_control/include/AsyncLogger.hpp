@@ -0,0 +1,243 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+
+/**
+ * @file AsyncLogger.hpp
+ * @brief Allocation-free logging for the control and CAN threads.
+ *
+ * The calling thread only copies a binary record (call site + arguments)
+ * into its own SPSCRingBuffer, which never blocks and never allocates.
+ * A background thread started with logStart() formats the records and
+ * writes them out, so a slow terminal or journald backlog never reaches
+ * the real-time threads. When a ring is full the oldest records are
+ * overwritten and counted, and every call site can be rate limited.
+ *
+ * Formats use "{}" for an argument and "{x}" for an integer in hex.
+ * Arguments are integers, booleans, floating point values and strings;
+ * strings are copied into the record and truncated to LOG_TEXT_SIZE in total.
+ */
+
+#define LOG_MAX_ARGS		4		/**< Arguments per record */
+#define LOG_TEXT_SIZE		64		/**< Bytes of string arguments per record */
+#define LOG_RING_SIZE		128		/**< Records per thread ring (power of two) */
+#define LOG_MAX_THREADS		8		/**< Threads logging at the same time */
+#define LOG_FLUSH_PERIOD	std::chrono::milliseconds(20)	/**< Background write period */
+
+/**
+ * @enum e_logStream
+ * @brief Output of a call site
+ */
+enum e_logStream : uint8_t {
+	LOG_OUT,	/**< Standard output */
+	LOG_ERR		/**< Standard error */
+};
+
+/**
+ * @struct s_logSite
+ * @brief Static description of one logging call site
+ *
+ * Created by the LOG_* macros, one per call site, so a record only needs
+ * a pointer to it. Also holds the rate limiting state of the site.
+ */
+typedef struct s_logSite {
+	const char				*format;
+	e_logStream				stream;
+	int64_t					minIntervalNs;	/**< 0 logs every call */
+	std::atomic<int64_t>	lastNs;			/**< Time of the last accepted record, 0 if none */
+	std::atomic<uint32_t>	suppressed;		/**< Calls dropped by the rate limit since then */
+} t_logSite;
+
+enum e_logArgType : uint8_t {
+	LOG_ARG_INT,
+	LOG_ARG_UINT,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_TEXT
+};
+
+/**
+ * @struct s_logArg
+ * @brief One argument of a record
+ */
+typedef struct s_logArg {
+	e_logArgType	type;
+	union {
+		int64_t		i;
+		uint64_t	u;
+		double		d;
+		uint32_t	text;	/**< Offset of the string in t_logRecord::text */
+	};
+} t_logArg;
+
+/**
+ * @struct s_logRecord
+ * @brief Binary log entry stored in the rings, formatted later
+ */
+typedef struct s_logRecord {
+	const t_logSite	*site;
+	int64_t			timestampNs;
+	uint32_t		suppressed;		/**< Rate limited calls before this one */
+	uint8_t			argc;
+	uint16_t		textUsed;
+	t_logArg		args[LOG_MAX_ARGS];
+	char			text[LOG_TEXT_SIZE];
+} t_logRecord;
+
+/**
+ * @brief Starts the background writer
+ *
+ * @param outFd Descriptor of LOG_OUT records
+ * @param errFd Descriptor of LOG_ERR records
+ * @return 0 if started, -1 if already running or the thread can't be created
+ */
+int			logStart(int outFd = STDOUT_FILENO, int errFd = STDERR_FILENO);
+
+/**
+ * @brief Stops the background writer after writing every queued record
+ */
+void		logStop();
+
+/**
+ * @brief Records lost because a ring was full or no ring was free
+ */
+uint64_t	logDropped();
+
+/**
+ * @brief Formats a record into a line, without the trailing newline
+ *
+ * @param record Record to format
+ * @param out Output buffer
+ * @param size Capacity of out
+ * @return Length written, truncated to size - 1
+ */
+size_t		logFormat(const t_logRecord &record, char *out, size_t size);
+
+/**
+ * @brief Copies a record into the ring of the calling thread (hot path)
+ */
+void		logSubmit(const t_logRecord &record);
+
+/**
+ * @brief Applies the rate limit of a site
+ *
+ * @param site Call site
+ * @param nowNs Current time
+ * @param suppressed Calls dropped since the last accepted one
+ * @return true if the call must be logged
+ */
+inline bool	logAdmit(t_logSite *site, int64_t nowNs, uint32_t *suppressed) {
+
+	if (site->minIntervalNs > 0) {
+		int64_t	last = site->lastNs.load(std::memory_order_relaxed);
+		if (last != 0 && nowNs - last < site->minIntervalNs) {
+			site->suppressed.fetch_add(1, std::memory_order_relaxed);
+			return (false);
+		}
+		site->lastNs.store(nowNs, std::memory_order_relaxed);
+	}
+	*suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+	return (true);
+}
+
+inline void	logPackText(t_logRecord &record, const char *str, size_t len) {
+
+	t_logArg	&arg = record.args[record.argc++];
+	size_t		room = LOG_TEXT_SIZE - record.textUsed;
+
+	if (len >= room)
+		len = room ? room - 1 : 0;
+	arg.type = LOG_ARG_TEXT;
+	arg.text = record.textUsed;
+	if (room) {
+		std::memcpy(record.text + record.textUsed, str, len);
+		record.text[record.textUsed + len] = '\0';
+		record.textUsed = static_cast<uint16_t>(record.textUsed + len + 1);
+	} else
+		arg.text = LOG_TEXT_SIZE - 1;	// Shares the last terminator
+}
+
+inline void	logPack(t_logRecord &record, const char *value) {
+
+	logPackText(record, value ? value : "(null)", value ? std::strlen(value) : 6);
+}
+
+inline void	logPack(t_logRecord &record, const std::string &value) {
+
+	logPackText(record, value.data(), value.size());
+}
+
+template <typename T>
+inline void	logPack(t_logRecord &record, const T &value) {
+
+	static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+		"Log arguments must be numbers or strings");
+
+	t_logArg	&arg = record.args[record.argc++];
+
+	if constexpr (std::is_floating_point<T>::value) {
+		arg.type = LOG_ARG_DOUBLE;
+		arg.d = static_cast<double>(value);
+	} else if constexpr (std::is_enum<T>::value || std::is_signed<T>::value) {
+		arg.type = LOG_ARG_INT;
+		arg.i = static_cast<int64_t>(value);
+	} else {
+		arg.type = LOG_ARG_UINT;
+		arg.u = static_cast<uint64_t>(value);
+	}
+}
+
+/**
+ * @brief Builds and submits a record if the site's rate limit allows it
+ */
+template <typename... Args>
+inline void	logRecord(t_logSite *site, const Args&... args) {
+
+	static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+
+	int64_t		now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	uint32_t	suppressed;
+
+	if (!logAdmit(site, now, &suppressed))
+		return ;
+
+	t_logRecord	record;
+	record.site = site;
+	record.timestampNs = now;
+	record.suppressed = suppressed;
+	record.argc = 0;
+	record.textUsed = 0;
+	(logPack(record, args), ...);
+	logSubmit(record);
+}
+
+/** Logs at most once per interval from this call site, the rest is counted */
+#define LOG_EVERY(interval, stream, format, ...) do { \
+		static t_logSite	logSite_ = {format, stream, \
+			std::chrono::nanoseconds(interval).count(), {0}, {0}}; \
+		logRecord(&logSite_, ##__VA_ARGS__); \
+	} while (0)
+
+#define LOG_INFO(format, ...)	LOG_EVERY(std::chrono::nanoseconds(0), LOG_OUT, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...)	LOG_EVERY(std::chrono::nanoseconds(0), LOG_ERR, format, ##__VA_ARGS__)
+
+/**
+ * @class LogSession
+ * @brief Runs the background writer for the lifetime of the object
+ */
+class LogSession {
+
+public:
+	LogSession() { logStart(); }
+	~LogSession() { logStop(); }
+
+	LogSession(const LogSession&) = delete;
+	LogSession& operator=(const LogSession&) = delete;
+};
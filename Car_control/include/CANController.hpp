@@ -1,6 +1,7 @@
 #pragma once
 
 #include "socketCAN.h"
+#include "TxLatencyTracker.hpp"
 #include <string>
 #include <iostream>
 #include <vector>
@@ -8,7 +9,7 @@
 #include <cstring>
 #include <stdexcept>
 #include <memory>
-#include <mutex>
+#include <sys/eventfd.h>
 
 /**
  * @file CANController.hpp
@@ -16,6 +17,14 @@
  *
  * Provides initialization, cleanup, sending and receiving
  * of classical CAN and CAN-FD frames, with RAII support.
+ *
+ * Transmission and reception use independent sockets bound to the
+ * same interface, plus a third high priority socket reserved for safety
+ * frames. A broadcast manager socket, when available, lets the kernel send
+ * cyclic frames (heartbeats) with its own timers. SocketCAN sockets are safe to use from several threads,
+ * so neither path takes a lock and TX latency does not depend on RX load.
+ * The RX socket also sees frames sent by other local sockets (including
+ * this controller's TX socket) unless a receive filter excludes them.
  */
 class CANController {
 
@@ -68,10 +77,22 @@ public:
 	/**
 	 * @brief Cleans up the CAN interface
 	 *
-	 * Closes the socket and resets internal state.
+	 * Closes the TX and RX sockets and resets internal state.
 	 */
 	void	cleanup();
 
+	/**
+	 * @brief Accepts only the given CAN IDs on this controller
+	 *
+	 * Installs kernel CAN_RAW_FILTER masks on the RX socket so unrelated bus
+	 * traffic never reaches user space. Replaces any previously installed filter.
+	 *
+	 * @param ids Array of 11-bit CAN identifiers to receive
+	 * @param count Number of identifiers (max CAN_MAX_FILTERS)
+	 * @throws CANException if CAN is not initialized or the filter is rejected
+	 */
+	void	setReceiveFilter(const uint16_t *ids, size_t count);
+
 	/**
 	 * @brief Sends a classical CAN frame (up to 8 bytes)
 	 *
@@ -82,6 +103,117 @@ public:
 	 */
 	void	sendFrame(uint16_t can_id, const int8_t* data, uint8_t len);
 
+	/**
+	 * @brief Sends a prebuilt frame on the dedicated high priority channel
+	 *
+	 * The priority socket is opened at initialization with SO_PRIORITY
+	 * CAN_PRIORITY_EMERGENCY and is used only for safety frames, so they
+	 * never wait behind regular traffic in the socket or the qdisc.
+	 * Performs no allocation, locking or exception handling.
+	 *
+	 * @param frame Fully built frame (e.g. CANProtocol::EMERGENCY_BRAKE_ON)
+	 * @return 0 if successful, -1 on error
+	 */
+	int		sendPriorityFrame(const struct can_frame &frame) noexcept;
+
+	/**
+	 * @brief Lets the kernel send a frame cyclically
+	 *
+	 * Sent once immediately, then every period by the CAN_BCM timers, with
+	 * no user-space wakeup. Starting an ID that is already cyclic replaces
+	 * its payload and period. Transmission stops on stopCyclicFrame() or
+	 * cleanup(), including when the process dies.
+	 *
+	 * @param frame Frame to repeat
+	 * @param period Transmission period (> 0)
+	 * @throws CANException if not initialized, CAN_BCM is unavailable or setup fails
+	 */
+	void	startCyclicFrame(const struct can_frame &frame,
+				std::chrono::microseconds period);
+
+	/**
+	 * @brief Atomically replaces the payload of a cyclic frame
+	 *
+	 * Keeps the running period. Performs no allocation, locking or
+	 * exception handling.
+	 *
+	 * @param frame New content, matched to its cyclic job by can_id
+	 * @param sendNow Also sends the new content right away
+	 * @return 0 if successful, -1 on error or if CAN_BCM is unavailable
+	 */
+	int		updateCyclicFrame(const struct can_frame &frame, bool sendNow) noexcept;
+
+	/**
+	 * @brief Stops the cyclic transmission of an ID
+	 *
+	 * @param can_id 11-bit CAN identifier of the cyclic frame
+	 * @throws CANException if not initialized, CAN_BCM is unavailable or no frame is cyclic for this ID
+	 */
+	void	stopCyclicFrame(uint16_t can_id);
+
+	/**
+	 * @brief Lets the kernel watch an ID for silence
+	 *
+	 * Regular frames on the ID are absorbed by CAN_BCM, only the first
+	 * frame, a timeout and a resume become events for receiveWatchEvent().
+	 * Watching an ID again replaces its timeout.
+	 *
+	 * @param can_id 11-bit CAN identifier to watch
+	 * @param timeout Silence reported as RX_TIMEOUT (> 0)
+	 * @throws CANException if not initialized, CAN_BCM is unavailable or setup fails
+	 */
+	void	watchFrame(uint16_t can_id, std::chrono::microseconds timeout);
+
+	/**
+	 * @brief Waits for the next event of a watched ID
+	 *
+	 * Sleeps in the kernel until an event arrives, the timeout expires or
+	 * wakeup() is called.
+	 *
+	 * @param opcode Event, RX_CHANGED (frame seen) or RX_TIMEOUT
+	 * @param frame Frame that triggered RX_CHANGED (may be nullptr)
+	 * @param timeout_ms Maximum wait in milliseconds (-1 waits forever)
+	 * @return 0 if an event was read, CAN_RX_TIMEOUT, CAN_RX_WAKEUP, -1 on
+	 *         error or if nothing can be watched
+	 */
+	int		receiveWatchEvent(uint32_t *opcode, struct can_frame *frame,
+				int timeout_ms);
+
+	/**
+	 * @brief Measures the time from write() to the TX echo of every frame sent
+	 *
+	 * The TX and priority sockets receive the echo of their own frames
+	 * (CAN_RAW_RECV_OWN_MSGS) with a kernel timestamp (SO_TIMESTAMPING),
+	 * filtered to the given IDs. With a driver that echoes on transmit
+	 * completion this is the time the frame actually left the controller.
+	 * Echoes are matched with their send by collectTxConfirmations().
+	 *
+	 * @param ids IDs this node sends (e.g. CANMSG::TX_IDS)
+	 * @param count Number of entries in ids (max CAN_MAX_FILTERS)
+	 * @throws CANException if not initialized or a socket option is rejected
+	 */
+	void	enableTxTimestamps(const uint16_t *ids, size_t count);
+
+	/**
+	 * @brief Matches the pending TX echoes with their sends (non-blocking)
+	 *
+	 * Drains the echoes queued on the TX and priority sockets and feeds the
+	 * per ID latency histograms. Call it from one thread only, regularly
+	 * enough to keep the echo queues short; the latency comes from kernel
+	 * timestamps, so the call interval does not affect it.
+	 * Performs no allocation, locking or exception handling.
+	 *
+	 * @return Number of sends confirmed, -1 if TX timestamps are disabled
+	 */
+	int		collectTxConfirmations() noexcept;
+
+	/**
+	 * @brief Per ID TX latency, queryable from any thread
+	 *
+	 * @return Histograms, nullptr if enableTxTimestamps() was not called
+	 */
+	const TxLatencyTracker	*txLatency() const { return (_txLatency.get()); }
+
 	/**
 	 * @brief Sends a CAN-FD frame (up to 64 bytes)
 	 *
@@ -100,6 +232,40 @@ public:
 	 */
 	int		receiveFrame(struct can_frame *frame);
 
+	/**
+	 * @brief Receives a classical CAN frame, blocking until one arrives
+	 *
+	 * Sleeps in the kernel until a frame is available, the timeout expires
+	 * or wakeup() is called.
+	 *
+	 * @param frame Pointer to struct can_frame to store received data
+	 * @param timeout_ms Maximum wait in milliseconds (-1 waits forever)
+	 * @return 0 if a frame was read, CAN_RX_TIMEOUT, CAN_RX_WAKEUP, -1 on
+	 *         error or if the controller is not initialized
+	 */
+	int		receiveFrameBlocking(struct can_frame *frame, int timeout_ms);
+
+	/**
+	 * @brief Receives every ready classical CAN frame in one syscall
+	 *
+	 * Blocks like receiveFrameBlocking(), then drains up to
+	 * CAN_RX_BATCH_SIZE frames into the preallocated batch with recvmmsg().
+	 *
+	 * @param batch Buffers prepared with can_rx_batch_init()
+	 * @param timeout_ms Maximum wait in milliseconds (-1 waits forever)
+	 * @return Number of frames read, 0 on timeout, CAN_RX_WAKEUP if woken up,
+	 *         -1 on error or if the controller is not initialized
+	 */
+	int		receiveBatch(t_canRxBatch *batch, int timeout_ms);
+
+	/**
+	 * @brief Interrupts any blocking receive on this controller
+	 *
+	 * The wakeup stays latched, so every later blocking receive returns
+	 * immediately. Intended for shutdown.
+	 */
+	void	wakeup();
+
 	/**
 	 * @brief Attempts to receive a CAN-FD frame (non-blocking)
 	 *
@@ -111,7 +277,11 @@ public:
 	// Getters
 	bool 				isInitialized() const { return _initialized; }	/**< Returns true if CAN is initialized */
 	const std::string&	getInterface() const { return _interface; }		/**< Returns interface name */
-	int 				getSocket() const { return _socket; }			/**< Returns socket file descriptor */
+	int 				getSocket() const { return _socket; }			/**< Returns TX socket file descriptor */
+	int 				getRxSocket() const { return _rxSocket; }		/**< Returns RX socket file descriptor */
+	int 				getPrioritySocket() const { return _prioritySocket; }	/**< Returns emergency TX socket */
+	int 				getWakeFd() const { return _wakeFd; }			/**< Returns shutdown wakeup descriptor */
+	int 				getBcmSocket() const { return _bcmSocket; }		/**< Returns CAN_BCM socket, -1 if unavailable */
 
 	/**
 	 * @class CANException
@@ -123,8 +293,15 @@ public:
 			: std::runtime_error("CAN Error: " + msg) {}
 	};
 private:
-	int					_socket;		/**< CAN socket file descriptor */
+	int					_socket;		/**< CAN TX socket file descriptor */
+	int					_rxSocket;		/**< CAN RX socket file descriptor */
+	int					_prioritySocket;	/**< High priority TX socket for safety frames */
+	int					_wakeFd;		/**< eventfd used to interrupt blocking receives */
+	int					_bcmSocket;		/**< Broadcast manager socket for cyclic and watched frames */
 	std::string			_interface;		/**< CAN interface name */
 	bool				_initialized;	/**< Indicates if CAN is initialized */
-	mutable std::mutex	_mutex;			/**< Protects CAN socket access */
+	std::unique_ptr<TxLatencyTracker>	_txLatency;		/**< Echo matching, nullptr when disabled */
+	std::unique_ptr<t_canRxBatch>		_echoBatch;		/**< Preallocated echo receive buffers */
+
+	void	cleanupSockets();
 };
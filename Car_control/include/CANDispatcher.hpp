@@ -0,0 +1,95 @@
+#pragma once
+
+#include "socketCAN.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file CANDispatcher.hpp
+ * @brief Table-driven routing of received CAN frames to per-ID handlers.
+ */
+
+/**
+ * @brief Handler called for every received frame of a registered ID
+ *
+ * @param frame Received frame
+ * @param timestampNs Receive time of the frame, in nanoseconds
+ * @param ctx Context pointer given at registration
+ */
+typedef void	(*t_canHandler)(const struct can_frame &frame,
+					int64_t timestampNs, void *ctx);
+
+/**
+ * @class CANDispatcher
+ * @brief O(1) CAN ID to handler registry
+ *
+ * Holds one entry per 11-bit standard ID in a flat array, so dispatching a
+ * frame is one bounds check, one load and one indirect call, with no
+ * virtual call and no branch per known ID. The registered IDs double as
+ * the list of IDs to subscribe to in the kernel receive filter.
+ *
+ * Registration is not thread-safe and must be done before dispatching starts.
+ */
+class CANDispatcher {
+
+public:
+	/** Number of standard (11-bit) CAN IDs */
+	static constexpr size_t	ID_COUNT = CAN_SFF_MASK + 1;
+
+	/**
+	 * @brief Registers the handler of a standard CAN ID
+	 *
+	 * @param can_id 11-bit CAN identifier
+	 * @param handler Function called for every frame with this ID
+	 * @param ctx Pointer passed back to the handler
+	 * @return 0 if successful, -1 if the ID is invalid, already taken or handler is NULL
+	 */
+	int		registerHandler(uint16_t can_id, t_canHandler handler, void *ctx);
+
+	/**
+	 * @brief Removes the handler of a CAN ID, if any
+	 *
+	 * @param can_id 11-bit CAN identifier
+	 */
+	void	unregisterHandler(uint16_t can_id);
+
+	/**
+	 * @brief Copies the registered IDs in ascending order
+	 *
+	 * @param ids Output array
+	 * @param max Capacity of ids
+	 * @return Total number of registered IDs (may exceed max, only max are copied)
+	 */
+	size_t	subscribedIds(uint16_t *ids, size_t max) const;
+
+	/**
+	 * @brief Routes a frame to its handler (hot path)
+	 *
+	 * Extended, RTR and error frames never match, since their flag bits put
+	 * can_id outside of the table.
+	 *
+	 * @param frame Received frame
+	 * @param timestampNs Receive time of the frame, in nanoseconds
+	 * @return true if a handler was called, false if the ID is not registered
+	 */
+	bool	dispatch(const struct can_frame &frame, int64_t timestampNs) const {
+
+		if (frame.can_id >= ID_COUNT)
+			return (false);
+
+		const Entry	&entry = _table[frame.can_id];
+		if (!entry.handler)
+			return (false);
+
+		entry.handler(frame, timestampNs, entry.ctx);
+		return (true);
+	}
+
+private:
+	struct Entry {
+		t_canHandler	handler;
+		void			*ctx;
+	};
+
+	Entry	_table[ID_COUNT] = {};
+};
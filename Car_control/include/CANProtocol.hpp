@@ -1,10 +1,14 @@
 #pragma once
 
 #include "CANController.hpp"
+#include "CANMessages.hpp"
 
 /**
  * @file CANProtocol.hpp
  * @brief CAN IDs and protocol helper functions for sending vehicle commands.
+ *
+ * Message layouts come from CANMessages.hpp, generated at build time from
+ * dbc/vehicle.dbc by tools/dbcgen.cpp.
  */
 
 /**
@@ -12,31 +16,126 @@
  * @brief Predefined CAN IDs used by the vehicle communication protocol to send messages.
  */
 namespace CANSENDID {
-	constexpr uint16_t	EMERGENCY_BRAKE 	= 0x100;	/**< Emergency brake command (max priority) */
-	constexpr uint16_t	DRIVING_COMMAND		= 0x101;	/**< driving command (medium prority) */
+	constexpr uint16_t	EMERGENCY_BRAKE 	= CANMSG::EMERGENCY_BRAKE::ID;	/**< Emergency brake command (max priority) */
+	constexpr uint16_t	DRIVING_COMMAND		= CANMSG::DRIVING_COMMAND::ID;	/**< driving command (medium prority) */
 };
 
+/**
+ * @namespace CANRECEIVERID
+ * @brief CAN IDs the application subscribes to.
+ *
+ * Each ID gets a handler in registerReceiverHandlers(), which also makes it
+ * part of the kernel receive filter. Anything else on the bus is discarded
+ * before reaching user space.
+ */
 namespace CANRECEIVERID {
-	constexpr uint16_t	SPEEDRPMSTM32			= 0x200; /**< Sensor speed value (heartbeat) */
-	constexpr uint16_t	BATTERYSTM32			= 0x201; /**< Expansion board status */
+	constexpr uint16_t	SPEEDRPMSTM32			= CANMSG::SPEED::ID; /**< Sensor speed value (heartbeat) */
+	constexpr uint16_t	BATTERYSTM32			= CANMSG::BATTERY::ID; /**< Expansion board status */
 };
 
+/**
+ * @namespace CANLAYOUT
+ * @brief Compile-time checks of the generated layouts against the STM32 firmware.
+ *
+ * A DBC change that silently moves bytes or flips byte order breaks the build.
+ */
+namespace CANLAYOUT {
+
+	constexpr bool	drivingCommandBytes() {
+
+		uint8_t	data[8] = {};
+		CANMSG::DRIVING_COMMAND::pack(data, {-1500, 0x1234});
+		return (data[0] == 0x24 && data[1] == 0xFA && data[2] == 0x34 && data[3] == 0x12);
+	}
+
+	constexpr bool	speedBytes() {
+
+		const uint8_t	data[8] = {0x12, 0x34};
+		return (CANMSG::SPEED::unpack(data).Rpm == 0x1234);
+	}
+
+	constexpr bool	batteryBytes() {
+
+		const uint8_t	data[8] = {0x00, 0x55, 0x0C};
+		return (CANMSG::BATTERY::unpack(data).Percentage == 0x55
+			&& CANMSG::BATTERY::unpack(data).Voltage == 0x0C);
+	}
+
+	static_assert(CANMSG::EMERGENCY_BRAKE::ID == 0x100 && CANMSG::DRIVING_COMMAND::ID == 0x101
+		&& CANMSG::SPEED::ID == 0x200 && CANMSG::BATTERY::ID == 0x201, "CAN IDs");
+	static_assert(drivingCommandBytes(), "DRIVING_COMMAND must be little-endian");
+	static_assert(speedBytes(), "SPEED must be big-endian");
+	static_assert(batteryBytes(), "BATTERY must be big-endian");
+}
+
 /**
  * @namespace CANProtocol
  * @brief High-level helper functions to send CAN messages.
  */
 namespace CANProtocol {
 
+	/**
+	 * @brief Builds the emergency brake frame at compile time.
+	 *
+	 * @param active True to activate brake, false to release
+	 */
+	constexpr struct can_frame	makeEmergencyBrakeFrame(bool active) {
+
+		struct can_frame frame{};
+		frame.can_id	= CANMSG::EMERGENCY_BRAKE::ID;
+		frame.len		= CANMSG::EMERGENCY_BRAKE::DLC;
+		CANMSG::EMERGENCY_BRAKE::Active::encode(frame.data, active ? 0xF : 0x00);
+		return (frame);
+	}
+
+	/** Prebuilt emergency brake frames, sent as is on the priority channel */
+	inline constexpr struct can_frame	EMERGENCY_BRAKE_ON	= makeEmergencyBrakeFrame(true);
+	inline constexpr struct can_frame	EMERGENCY_BRAKE_OFF	= makeEmergencyBrakeFrame(false);
+
+	/** Period of the EMERGENCY_BRAKE(false) heartbeat watched by the STM32 */
+	constexpr std::chrono::milliseconds	HEARTBEAT_PERIOD{300};
+
+	/** Period of the repeated EMERGENCY_BRAKE(true) in autonomous mode */
+	constexpr std::chrono::milliseconds	BRAKE_REPEAT_PERIOD{100};
+
+	/**
+	 * @brief Lets the kernel repeat the emergency brake frame.
+	 *
+	 * The heartbeat and the repeated brake are the same cyclic job on the
+	 * EMERGENCY_BRAKE ID, so starting one replaces the other.
+	 *
+	 * @param can Reference to an initialized CANController
+	 * @param active Brake state carried by every repetition
+	 * @param period Repetition period
+	 * @return true if the kernel now repeats the frame, false if CAN_BCM is unavailable
+	 * @throws CANController::CANException if the cyclic job could not be started
+	 */
+	inline bool startCyclicBrake(CANController& can, bool active,
+					std::chrono::microseconds period) {
+
+		if (can.getBcmSocket() < 0)
+			return (false);
+		can.startCyclicFrame(active ? EMERGENCY_BRAKE_ON : EMERGENCY_BRAKE_OFF, period);
+		return (true);
+	}
+
 	/**
 	 * @brief Sends an emergency brake command over CAN.
 	 *
+	 * Uses the controller's dedicated high priority channel, so the brake
+	 * never queues behind driving commands. This is a one-shot frame, the
+	 * kernel heartbeat keeps its own state and period.
+	 *
 	 * @param can Reference to an initialized CANController
 	 * @param active True to activate brake, false to release
+	 * @throws CANController::CANException if the frame could not be sent
 	 */
 	inline void sendEmergencyBrake(CANController& can, bool active) {
 
-		int8_t data = active ? 0xF : 0x00;
-		can.sendFrame(CANSENDID::EMERGENCY_BRAKE, &data, 1);
+		const struct can_frame	&frame = active ? EMERGENCY_BRAKE_ON : EMERGENCY_BRAKE_OFF;
+
+		if (can.sendPriorityFrame(frame) < 0)
+			throw CANController::CANException("Failed to send emergency brake");
 	}
 
 	/**
@@ -44,14 +143,13 @@ namespace CANProtocol {
 	 *
 	 * @param can Reference to an initialized CANController
 	 * @param throttle Throttle value to send
+	 * @param steering Steering value to send
 	 */
 	inline void sendDrivingCommand(CANController& can, int16_t throttle, int16_t steering) {
 
-		int8_t data[4];
-		data[0] = static_cast<int8_t>(throttle & 0xFF);         // Low byte
-		data[1] = static_cast<int8_t>((throttle >> 8) & 0xFF);  // High byte
-		data[2] = static_cast<int8_t>(steering & 0xFF);         // Steering Low byte
-    	data[3] = static_cast<int8_t>((steering >> 8) & 0xFF);  // Steering High byte
-		can.sendFrame(CANSENDID::DRIVING_COMMAND, data, 4);
+		uint8_t data[8] = {};
+		CANMSG::DRIVING_COMMAND::pack(data, {throttle, steering});
+		can.sendFrame(CANMSG::DRIVING_COMMAND::ID, reinterpret_cast<const int8_t*>(data),
+			CANMSG::DRIVING_COMMAND::DLC);
 	}
 }
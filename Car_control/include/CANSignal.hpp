@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ratio>
+#include <type_traits>
+
+/**
+ * @file CANSignal.hpp
+ * @brief Compile-time CAN signal codec.
+ *
+ * A signal is described once by its position, size, byte order, scale and
+ * offset, following the DBC conventions. Every parameter is a template
+ * argument, so encoders and decoders fold down to a few shifts and masks
+ * and can be checked with static_assert.
+ *
+ * Bits are numbered like in DBC files: bit 0 is the least significant bit
+ * of data[0]. For little-endian (Intel) signals StartBit is the least
+ * significant bit of the signal; for big-endian (Motorola) signals it is
+ * the most significant one.
+ */
+
+/**
+ * @enum ByteOrder
+ * @brief Byte order of a signal inside the payload
+ */
+enum class ByteOrder {
+	LittleEndian,	/**< Intel, DBC "@1" */
+	BigEndian		/**< Motorola, DBC "@0" */
+};
+
+namespace CANCodec {
+
+	/** @brief Reads the 8 payload bytes as a little-endian word */
+	constexpr uint64_t	loadLE(const uint8_t (&data)[8]) {
+
+		// Written out so the compiler merges it into one load
+		return (static_cast<uint64_t>(data[0])
+			| static_cast<uint64_t>(data[1]) << 8
+			| static_cast<uint64_t>(data[2]) << 16
+			| static_cast<uint64_t>(data[3]) << 24
+			| static_cast<uint64_t>(data[4]) << 32
+			| static_cast<uint64_t>(data[5]) << 40
+			| static_cast<uint64_t>(data[6]) << 48
+			| static_cast<uint64_t>(data[7]) << 56);
+	}
+
+	/** @brief Writes a little-endian word back to the 8 payload bytes */
+	constexpr void	storeLE(uint8_t (&data)[8], uint64_t word) {
+
+		// Written out so the compiler merges it into one store
+		data[0] = static_cast<uint8_t>(word);
+		data[1] = static_cast<uint8_t>(word >> 8);
+		data[2] = static_cast<uint8_t>(word >> 16);
+		data[3] = static_cast<uint8_t>(word >> 24);
+		data[4] = static_cast<uint8_t>(word >> 32);
+		data[5] = static_cast<uint8_t>(word >> 40);
+		data[6] = static_cast<uint8_t>(word >> 48);
+		data[7] = static_cast<uint8_t>(word >> 56);
+	}
+
+	/** @brief Reverses the byte order of a word */
+	constexpr uint64_t	byteSwap(uint64_t word) {
+
+		return ((word & 0xFFULL) << 56 | (word & 0xFF00ULL) << 40
+			| (word & 0xFF0000ULL) << 24 | (word & 0xFF000000ULL) << 8
+			| (word >> 8 & 0xFF000000ULL) | (word >> 24 & 0xFF0000ULL)
+			| (word >> 40 & 0xFF00ULL) | (word >> 56));
+	}
+
+	/** @brief Mask of the Length lowest bits */
+	constexpr uint64_t	lowMask(unsigned length) {
+		return (length >= 64 ? ~0ULL : (1ULL << length) - 1);
+	}
+}
+
+/**
+ * @brief One signal of a CAN message
+ *
+ * physical = raw * Scale + Offset
+ *
+ * @tparam T Physical value type (signed types are sign extended from Length bits)
+ * @tparam StartBit DBC start bit
+ * @tparam Length Size of the signal in bits (1 to 64)
+ * @tparam Order Byte order of the signal
+ * @tparam Scale Factor applied to the raw value, as a std::ratio
+ * @tparam Offset Added after scaling, as a std::ratio
+ */
+template <typename T, unsigned StartBit, unsigned Length,
+		ByteOrder Order = ByteOrder::LittleEndian,
+		typename Scale = std::ratio<1>, typename Offset = std::ratio<0>>
+struct CANSignal {
+
+	static_assert(std::is_arithmetic<T>::value, "CAN signals must be arithmetic");
+	static_assert(Length >= 1 && Length <= 64, "CAN signal length must be 1 to 64 bits");
+	static_assert(StartBit < 64, "CAN signal start bit must be inside the payload");
+	static_assert(Scale::num != 0, "CAN signal scale can't be zero");
+
+	typedef T	value_type;
+
+	static constexpr unsigned	START_BIT = StartBit;
+	static constexpr unsigned	LENGTH = Length;
+	static constexpr ByteOrder	ORDER = Order;
+
+private:
+	// Motorola signals are handled as Intel ones in the byte swapped word
+	static constexpr unsigned	MSB_SWAPPED = (7 - StartBit / 8) * 8 + StartBit % 8;
+
+	static constexpr bool		IS_LE = (Order == ByteOrder::LittleEndian);
+
+	static_assert(IS_LE ? StartBit + Length <= 64 : MSB_SWAPPED + 1 >= Length,
+		"CAN signal does not fit in 8 bytes");
+
+	static constexpr unsigned	SHIFT = IS_LE ? StartBit : MSB_SWAPPED + 1 - Length;
+	static constexpr uint64_t	MASK = CANCodec::lowMask(Length);
+
+	static constexpr bool		IDENTITY = Scale::num == Scale::den
+		&& Offset::num == 0 && std::is_integral<T>::value;
+
+	static constexpr uint64_t	word(const uint8_t (&data)[8]) {
+		uint64_t w = CANCodec::loadLE(data);
+		return (IS_LE ? w : CANCodec::byteSwap(w));
+	}
+
+public:
+	/** Bits used by the signal, in the little-endian payload word */
+	static constexpr uint64_t	PAYLOAD_MASK = IS_LE ? MASK << SHIFT
+		: CANCodec::byteSwap(MASK << SHIFT);
+
+	/** @brief Extracts the raw value, sign extended for signed types */
+	static constexpr int64_t	raw(const uint8_t (&data)[8]) {
+
+		uint64_t	value = (word(data) >> SHIFT) & MASK;
+
+		if (std::is_signed<T>::value && Length < 64 && (value >> (Length - 1)) & 1)
+			value |= ~MASK;
+		return (static_cast<int64_t>(value));
+	}
+
+	/** @brief Decodes the physical value */
+	static constexpr T	decode(const uint8_t (&data)[8]) {
+
+		const int64_t	r = raw(data);
+
+		if constexpr (IDENTITY)
+			return (static_cast<T>(r));
+		else if constexpr (std::is_floating_point<T>::value)
+			return (static_cast<T>(static_cast<double>(r) * Scale::num / Scale::den
+				+ static_cast<double>(Offset::num) / Offset::den));
+		else
+			return (static_cast<T>(r * Scale::num / Scale::den + Offset::num / Offset::den));
+	}
+
+	/** @brief Encodes a physical value, leaving the other signals untouched */
+	static constexpr void	encode(uint8_t (&data)[8], T value) {
+
+		int64_t		r = 0;
+
+		if constexpr (IDENTITY)
+			r = static_cast<int64_t>(value);
+		else if constexpr (std::is_floating_point<T>::value) {
+			double scaled = (static_cast<double>(value)
+				- static_cast<double>(Offset::num) / Offset::den) * Scale::den / Scale::num;
+			r = static_cast<int64_t>(scaled >= 0 ? scaled + 0.5 : scaled - 0.5);
+		} else
+			r = (static_cast<int64_t>(value) - Offset::num / Offset::den)
+				* Scale::den / Scale::num;
+
+		uint64_t	w = word(data);
+		w = (w & ~(MASK << SHIFT)) | ((static_cast<uint64_t>(r) & MASK) << SHIFT);
+		CANCodec::storeLE(data, IS_LE ? w : CANCodec::byteSwap(w));
+	}
+};
+
+/**
+ * @brief Checks that signals fit in the message length and don't overlap
+ *
+ * Meant for static_assert next to each message description.
+ *
+ * @tparam Dlc Message length in bytes
+ * @tparam Signals Signals of the message
+ */
+template <uint8_t Dlc, typename... Signals>
+constexpr bool	validLayout() {
+
+	const uint64_t	masks[] = {Signals::PAYLOAD_MASK..., 0};
+	const uint64_t	allowed = CANCodec::lowMask(Dlc * 8);
+	uint64_t		used = 0;
+
+	if (Dlc > 8)
+		return (false);
+	for (size_t i = 0; i < sizeof...(Signals); i++) {
+		if ((masks[i] & ~allowed) || (masks[i] & used))
+			return (false);
+		used |= masks[i];
+	}
+	return (true);
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "LatencyHistogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @file CyclicExecutive.hpp
+ * @brief timerfd driven scheduler for the periodic control loops.
+ */
+
+/**
+ * @brief Body of a periodic task, called once per release
+ *
+ * @param ctx Context pointer given at registration
+ */
+typedef void	(*t_cyclicTask)(void *ctx);
+
+/**
+ * @struct s_taskStats
+ * @brief Timing statistics of one task, all durations in nanoseconds
+ */
+typedef struct s_taskStats {
+	uint64_t	runs;			/**< Completed releases */
+	uint64_t	overruns;		/**< Releases missed because the task ran past its next deadline */
+	int64_t		lastJitterNs;	/**< Start delay of the last release */
+	int64_t		maxJitterNs;	/**< Worst start delay */
+	int64_t		lastExecNs;		/**< Execution time of the last release */
+	int64_t		wcetNs;			/**< Worst observed execution time */
+	int64_t		totalExecNs;	/**< Sum of execution times, for the average */
+} t_taskStats;
+
+/**
+ * @class CyclicExecutive
+ * @brief Runs periodic tasks from one thread on CLOCK_MONOTONIC absolute deadlines
+ *
+ * Releases are computed as start + phase + k * period, so periods never
+ * drift with execution time or wakeup latency the way sleep_for() loops do.
+ * A single timerfd armed with TFD_TIMER_ABSTIME sleeps until the earliest
+ * release. Tasks due at the same time run in registration order. A task
+ * that runs past its next release is counted as an overrun and its missed
+ * releases are skipped instead of being run back to back.
+ *
+ * Input descriptors can be watched in the same wait: their task runs as
+ * soon as the descriptor is readable, between releases, so input latency
+ * doesn't depend on the periods.
+ *
+ * Registration is not thread-safe and must be done before run().
+ */
+class CyclicExecutive {
+
+public:
+	/** Maximum number of tasks of one executive */
+	static constexpr size_t	MAX_TASKS = 8;
+
+	/** Maximum number of input descriptors of one executive */
+	static constexpr size_t	MAX_INPUTS = 4;
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @throws std::runtime_error if the timerfd or the stop eventfd can't be created
+	 */
+	CyclicExecutive();
+
+	/**
+	 * @brief Destructor, closes the timer and stop descriptors
+	 */
+	~CyclicExecutive();
+
+	CyclicExecutive(const CyclicExecutive&) = delete;
+	CyclicExecutive& operator=(const CyclicExecutive&) = delete;
+
+	/**
+	 * @brief Registers a periodic task
+	 *
+	 * @param name Label used in reports, must outlive the executive
+	 * @param task Function called at every release
+	 * @param ctx Pointer passed back to the task
+	 * @param period Release period (> 0)
+	 * @param phase Offset of the first release from the start of run()
+	 * @return Task index if successful, -1 if invalid or MAX_TASKS is reached
+	 */
+	int		addTask(const char *name, t_cyclicTask task, void *ctx,
+				std::chrono::nanoseconds period,
+				std::chrono::nanoseconds phase = std::chrono::nanoseconds(0));
+
+	/**
+	 * @brief Registers a task woken by a readable descriptor
+	 *
+	 * The task must consume what is readable, otherwise it runs again
+	 * right away. On error or hangup it runs once more so it can notice,
+	 * then the descriptor is no longer watched.
+	 *
+	 * @param name Label used in reports, must outlive the executive
+	 * @param fd Descriptor to watch, owned by the caller
+	 * @param task Function called when fd is readable
+	 * @param ctx Pointer passed back to the task
+	 * @return Input index if successful, -1 if invalid or MAX_INPUTS is reached
+	 */
+	int		addInput(const char *name, int fd, t_cyclicTask task, void *ctx);
+
+	/**
+	 * @brief Runs the tasks until stop() is called or running becomes false
+	 *
+	 * running is checked after every wakeup, so shutdown takes at most the
+	 * shortest period.
+	 *
+	 * @param running Flag to follow (e.g. g_running)
+	 * @return 0 when stopped, -1 on timer error or if no task is registered
+	 */
+	int		run(const std::atomic<bool> &running);
+
+	/**
+	 * @brief Makes run() return, callable from a task or another thread
+	 */
+	void	stop();
+
+	/**
+	 * @brief Statistics of a task
+	 *
+	 * Updated by the thread calling run(), read them from a task or once
+	 * run() returned.
+	 *
+	 * @param index Index returned by addTask()
+	 */
+	const t_taskStats	&stats(size_t index) const { return (_tasks[index].stats); }
+
+	/**
+	 * @brief Start delay distribution of a task, readable from any thread
+	 *
+	 * @param index Index returned by addTask()
+	 */
+	const LatencyHistogram	&jitter(size_t index) const { return (_jitter[index]); }
+
+	/** @brief Number of registered tasks */
+	size_t	taskCount() const { return (_count); }
+
+	/** @brief Number of times the task of an input ran */
+	uint64_t	inputWakeups(size_t index) const { return (_inputs[index].wakeups); }
+
+	/**
+	 * @brief Writes one line of statistics per task
+	 *
+	 * @param out Stream to write to
+	 * @param prefix Prepended to every line (e.g. "[MANUAL] ")
+	 */
+	void	report(std::ostream &out, const char *prefix) const;
+
+private:
+	struct Task {
+		const char		*name;
+		t_cyclicTask	task;
+		void			*ctx;
+		int64_t			periodNs;
+		int64_t			phaseNs;
+		int64_t			nextReleaseNs;
+		t_taskStats		stats;
+	};
+
+	struct Input {
+		const char		*name;
+		int				fd;
+		t_cyclicTask	task;
+		void			*ctx;
+		uint64_t		wakeups;
+	};
+
+	Task				_tasks[MAX_TASKS] = {};
+	LatencyHistogram	_jitter[MAX_TASKS];
+	size_t				_count = 0;
+	Input				_inputs[MAX_INPUTS] = {};
+	size_t				_inputCount = 0;
+	int					_timerFd = -1;
+	int					_stopFd = -1;
+	std::atomic<bool>	_stopped{false};
+
+	int		armTimer(int64_t deadlineNs);
+	void	release(Task &task, int64_t nowNs);
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "CANController.hpp"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @file DrivingCommandPublisher.hpp
+ * @brief Rate controlled DRIVING_COMMAND transmission with latest-value semantics.
+ */
+
+/**
+ * @enum e_publishAction
+ * @brief What a publisher call put on the bus
+ */
+enum e_publishAction {
+	PUBLISH_NONE,		/**< Nothing sent */
+	PUBLISH_CHANGE,		/**< Significant setpoint change sent right away */
+	PUBLISH_REFRESH		/**< Latest setpoint repeated by the fixed rate */
+};
+
+/**
+ * @struct s_publisherConfig
+ * @brief Timing and change thresholds of a DrivingCommandPublisher
+ */
+typedef struct s_publisherConfig {
+	std::chrono::nanoseconds	period{std::chrono::milliseconds(20)};	/**< Refresh period, caps staleness */
+	std::chrono::nanoseconds	minGap{std::chrono::milliseconds(5)};	/**< Minimum time between two frames */
+	int16_t						throttleStep = 10;	/**< Significant throttle change */
+	int16_t						steeringStep = 2;	/**< Significant steering change */
+} t_publisherConfig;
+
+/**
+ * @struct s_publisherStats
+ * @brief Frame counters of a DrivingCommandPublisher
+ */
+typedef struct s_publisherStats {
+	uint64_t	changes;	/**< Frames sent on a significant change */
+	uint64_t	refreshes;	/**< Frames sent by the fixed rate */
+	uint64_t	deferred;	/**< Significant updates held back by the minimum gap */
+} t_publisherStats;
+
+/**
+ * @class DrivingCommandPublisher
+ * @brief Sends the latest driving setpoint at a fixed rate and on change
+ *
+ * The MCU keeps executing the last command it received, so the setpoint is
+ * repeated every period: a lost frame is corrected at most one period later.
+ * A significant change is sent at once unless the previous frame is less
+ * than minGap old, in which case it goes out as soon as the gap has elapsed.
+ * Intermediate setpoints are overwritten, never queued, so a stick sweep
+ * costs at most one frame per minGap.
+ *
+ * Not thread-safe, drive it from the control thread. Times are
+ * CLOCK_MONOTONIC (steady_clock) nanoseconds.
+ */
+class DrivingCommandPublisher {
+
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param can Controller to send with, nullptr only computes the schedule
+	 * @param config Rate and thresholds, period and minGap must be > 0
+	 */
+	DrivingCommandPublisher(CANController *can,
+		const t_publisherConfig &config = t_publisherConfig{});
+
+	/**
+	 * @brief Replaces the setpoint, sends it if the change is significant
+	 *
+	 * Also resumes a paused publisher.
+	 *
+	 * @param throttle Throttle value
+	 * @param steering Steering value
+	 * @param nowNs Current time
+	 * @return What was sent
+	 * @throws CANController::CANException if the frame could not be sent
+	 */
+	e_publishAction	update(int16_t throttle, int16_t steering, int64_t nowNs);
+
+	/**
+	 * @brief Flushes a deferred change or refreshes the setpoint when due
+	 *
+	 * Call it at least every minGap; staleness is bounded by period plus
+	 * the call interval.
+	 *
+	 * @param nowNs Current time
+	 * @return What was sent
+	 * @throws CANController::CANException if the frame could not be sent
+	 */
+	e_publishAction	tick(int64_t nowNs);
+
+	/**
+	 * @brief Stops sending until the next update() (brake hold, shutdown)
+	 */
+	void	pause() { _paused = true; }
+
+	/** @brief Frame counters */
+	const t_publisherStats	&stats() const { return (_stats); }
+
+	/**
+	 * @brief Writes the frame counters on one line
+	 *
+	 * @param out Stream to write to
+	 * @param prefix Prepended to the line (e.g. "[MANUAL] ")
+	 */
+	void	report(std::ostream &out, const char *prefix) const;
+
+private:
+	CANController		*_can;
+	t_publisherConfig	_config;
+	t_publisherStats	_stats = {};
+	int16_t				_throttle = 0;
+	int16_t				_steering = 0;
+	int16_t				_sentThrottle = 0;
+	int16_t				_sentSteering = 0;
+	int64_t				_lastSentNs = 0;
+	bool				_hasSetpoint = false;
+	bool				_hasSent = false;
+	bool				_pending = false;	/**< Significant change not sent yet */
+	bool				_paused = false;
+
+	e_publishAction	publish(int64_t nowNs);
+	void			send(int64_t nowNs);
+};
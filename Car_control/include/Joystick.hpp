@@ -17,12 +17,61 @@
  * handling deadzones, and stabilizing input values for embedded control.
  */
 
+/**
+ * @struct s_joystickReport
+ * @brief Coalesced state of one HID report (events up to SYN_REPORT)
+ */
+typedef struct s_joystickReport {
+	int16_t		steering;	/**< getAbs(ABS_Z) once the report is complete */
+	int16_t		throttle;	/**< getAbs(ABS_Y) once the report is complete */
+	uint32_t	pressed;	/**< Button press edges, bit (code - BTN_SOUTH), same numbering as readPress() */
+	bool		resynced;	/**< Built after SYN_DROPPED: axes are current, edges may be missing */
+} t_joystickReport;
+
+// Fixed point of the axis reciprocals, exact for ranges up to AXIS_MAX_RANGE
+#define AXIS_SCALE_SHIFT	48
+#define AXIS_MAX_RANGE		(1 << 20)
+
+/**
+ * @struct s_axisScale
+ * @brief Precomputed normalization of one absolute axis
+ *
+ * Replaces ((value - origin) * span) / range with a multiply-shift by
+ * ceil(span * 2^AXIS_SCALE_SHIFT / range), which gives the same truncated
+ * result for every |value - origin| <= range <= AXIS_MAX_RANGE.
+ */
+typedef struct s_axisScale {
+	bool		present;	/**< Axis reported by the device with a usable range */
+	bool		inverted;	/**< origin - value instead of value - origin */
+	int32_t		origin;		/**< Minimum (steering) or center of the axis */
+	uint32_t	range;		/**< maximum - minimum */
+	uint64_t	factor;		/**< Span reciprocal in AXIS_SCALE_SHIFT fixed point */
+	int16_t		low;		/**< Clamp of the normalized value */
+	int16_t		high;
+} t_axisScale;
+
+/**
+ * @brief Builds the normalization of an axis from its absinfo limits
+ *
+ * ABS_Z maps to 0..180, every other axis to -100..100 (inverted).
+ *
+ * @return Scale with present false if the range is empty or above AXIS_MAX_RANGE
+ */
+t_axisScale	makeAxisScale(int axis_code, int32_t minimum, int32_t maximum);
+
+/**
+ * @brief Normalizes a raw axis value, no division
+ */
+int16_t		scaleAxis(const t_axisScale &scale, int32_t value);
+
 class Joystick {
 	private:
 		struct libevdev		*dev = nullptr;	/**< libevdev device handle */
 		struct input_event	ev;				/**< Last input event */
 		int 				rc;				/**< Return code for libevdev calls */
 		int					fd;				/**< File descriptor for joystick device */
+		uint32_t			_pressed = 0;	/**< Press edges of the report being read */
+		t_axisScale			_axes[ABS_CNT] = {};	/**< Built once from the device absinfo */
 		std::string			_device;		/**< Device path (e.g., /dev/input/eventX) */
 	public:
 		/**
@@ -49,12 +98,56 @@ class Joystick {
 		 *
 		 * Only considers key/button press events (ignores EV_SYN and releases).
 		 *
+		 * A SYN_DROPPED from the kernel is resynchronized here, so axis
+		 * values stay correct after an event buffer overflow.
+		 *
 		 * @return Button code (ev.code - 304) if pressed, -1 if no button press
 		 * and -2 if controller disconnected
-		 * @throws std::runtime_error if device is removed or read fails
 		 */
 		int		readPress(void);
+
+		/**
+		 * @brief Reads the next complete HID report.
+		 *
+		 * Consumes events up to the next SYN_REPORT and returns them as one
+		 * snapshot, so a fast stick sweep costs one report instead of one
+		 * read per axis event. An incomplete report stays buffered until its
+		 * SYN_REPORT arrives. After SYN_DROPPED the device state is
+		 * resynchronized and returned as a report with resynced set.
+		 *
+		 * @param report Filled when 1 is returned
+		 * @return 1 if a report was read, 0 if no complete report is queued,
+		 * -1 if the controller is disconnected
+		 */
+		int		readReport(t_joystickReport *report);
+
+		/**
+		 * @brief Sleeps until the device has an event to read, or the timeout.
+		 *
+		 * @param timeout_ms Maximum wait in milliseconds (-1 waits forever, 0 polls)
+		 * @return 1 if an event is pending, 0 on timeout, -1 on error or if
+		 * the device was removed
+		 */
+		int		waitEvent(int timeout_ms) const;
 	
+		/**
+		 * @brief Tells if readPress() has an event to consume (non-blocking).
+		 *
+		 * Includes axis and sync events, which keep getAbs() up to date.
+		 *
+		 * @return true if an event is queued in libevdev or readable on the device
+		 */
+		bool	hasPendingEvent(void) const;
+
+		/**
+		 * @brief Device file descriptor, for poll/epoll readiness.
+		 *
+		 * Readable means hasPendingEvent() will report the new events.
+		 *
+		 * @return Open file descriptor of the evdev device
+		 */
+		int		getFd(void) const;
+
 		/**
 		 * @brief Detects connected joystick device and sets _device path.
 		 *
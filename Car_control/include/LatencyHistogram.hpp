@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file LatencyHistogram.hpp
+ * @brief Fixed memory log-linear latency histogram, recordable from any thread.
+ */
+
+/**
+ * @struct s_histogramSummary
+ * @brief Snapshot of a histogram, all values in nanoseconds
+ *
+ * Percentiles are the upper bound of the bucket holding them, clamped
+ * to [minNs, maxNs], so they are within 1/32 above the exact value.
+ */
+typedef struct s_histogramSummary {
+	uint64_t	count;
+	int64_t		minNs;		/**< 0 if empty */
+	int64_t		maxNs;
+	int64_t		meanNs;
+	int64_t		p50Ns;
+	int64_t		p90Ns;
+	int64_t		p99Ns;
+	int64_t		p999Ns;
+} t_histogramSummary;
+
+/**
+ * @class LatencyHistogram
+ * @brief HDR style histogram: every power of two split into linear sub-buckets
+ *
+ * Values below SUB_COUNT ns have a bucket each. Above, every range
+ * [2^k, 2^(k+1)) is split into HALF_COUNT buckets of equal width, so the
+ * relative error stays below 1/32 from nanoseconds up to 2^MAX_BITS ns
+ * (about 68 s) in 8 KiB. Larger values are counted in the last bucket,
+ * min and max stay exact.
+ *
+ * record() is wait-free apart from the min/max compare-and-swap and can be
+ * called from any number of threads; readers see relaxed but complete
+ * values and may be a few records behind. Nothing allocates.
+ */
+class LatencyHistogram {
+
+public:
+	/** log2 of the number of buckets per power of two, doubled */
+	static constexpr int		SUB_BITS = 6;
+	static constexpr int64_t	SUB_COUNT = 1LL << SUB_BITS;
+	static constexpr int64_t	HALF_COUNT = SUB_COUNT / 2;
+
+	/** Values from 2^MAX_BITS ns on share the last bucket */
+	static constexpr int		MAX_BITS = 36;
+
+	/** Number of buckets */
+	static constexpr size_t		BUCKETS = SUB_COUNT + (MAX_BITS - SUB_BITS) * HALF_COUNT;
+
+	LatencyHistogram() = default;
+
+	LatencyHistogram(const LatencyHistogram&) = delete;
+	LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+	/**
+	 * @brief Records one value (hot path)
+	 *
+	 * @param valueNs Latency in nanoseconds, negative values count as 0
+	 */
+	void		record(int64_t valueNs) noexcept;
+
+	/**
+	 * @brief Clears every count, records running concurrently may survive it
+	 */
+	void		reset() noexcept;
+
+	/** @brief Number of values recorded */
+	uint64_t	count() const { return (_count.load(std::memory_order_relaxed)); }
+
+	/**
+	 * @brief Value at a percentile
+	 *
+	 * @param percent Percentile in [0, 100]
+	 * @return Upper bound of its bucket clamped to [min, max], min for 0, 0 if empty
+	 */
+	int64_t		percentile(double percent) const noexcept;
+
+	/**
+	 * @brief Count, min, max, mean and the usual percentiles in one pass
+	 *
+	 * @param summary Output, zeroed if nothing was recorded
+	 */
+	void		summarize(t_histogramSummary *summary) const noexcept;
+
+	/** @brief Values recorded in a bucket */
+	uint64_t	bucketCount(size_t bucket) const {
+		return (_buckets[bucket].load(std::memory_order_relaxed));
+	}
+
+	/** @brief Bucket a value falls in */
+	static size_t	bucketOf(int64_t valueNs) noexcept;
+
+	/** @brief Lowest value of a bucket */
+	static int64_t	bucketLow(size_t bucket) noexcept;
+
+	/** @brief Highest value of a bucket */
+	static int64_t	bucketHigh(size_t bucket) noexcept;
+
+private:
+	std::atomic<uint64_t>	_buckets[BUCKETS] = {};
+	std::atomic<uint64_t>	_count{0};
+	std::atomic<int64_t>	_sumNs{0};
+	std::atomic<int64_t>	_minNs{INT64_MAX};
+	std::atomic<int64_t>	_maxNs{0};
+
+	int64_t		valueAt(uint64_t rank, uint64_t total, const uint64_t *counts,
+					int64_t minNs, int64_t maxNs) const noexcept;
+	void		loadBounds(int64_t *minNs, int64_t *maxNs) const noexcept;
+};
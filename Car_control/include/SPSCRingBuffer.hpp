@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @file SPSCRingBuffer.hpp
+ * @brief Fixed-capacity lock-free single-producer/single-consumer queue.
+ *
+ * Storage is embedded in the object, so nothing is allocated after
+ * construction. Producer and consumer indices live on separate cache lines.
+ *
+ * Exactly one thread may call push() and exactly one thread may call pop()
+ * at any time. The queue keeps the newest samples: when it is full, push()
+ * overwrites the oldest element instead of failing, and the consumer skips
+ * whatever was overwritten (counted in dropped()). Every slot carries a
+ * sequence number, so a slot overwritten while being read is detected and
+ * discarded rather than returned torn.
+ */
+template <typename T, size_t Capacity>
+class SPSCRingBuffer {
+
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+		"SPSCRingBuffer capacity must be a power of two");
+	static_assert(std::is_trivially_copyable<T>::value,
+		"SPSCRingBuffer elements must be trivially copyable");
+
+public:
+	SPSCRingBuffer() = default;
+
+	// Shared between threads by address only
+	SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+	SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+	/**
+	 * @brief Appends an element, overwriting the oldest one if full (producer side)
+	 *
+	 * Never blocks and never fails.
+	 *
+	 * @param item Element to copy into the buffer
+	 */
+	void	push(const T &item) noexcept {
+
+		const uint64_t	head = _head.load(std::memory_order_relaxed);
+		Slot			&slot = _slots[head & MASK];
+
+		// Odd sequence marks the slot as being written
+		slot.seq.store(2 * head + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.data = item;
+		slot.seq.store(2 * head + 2, std::memory_order_release);
+		_head.store(head + 1, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Removes the oldest element still available (consumer side)
+	 *
+	 * @param item Output for the removed element
+	 * @return true if an element was removed, false if the buffer was empty
+	 */
+	bool	pop(T &item) noexcept {
+
+		uint64_t	tail = _tail.load(std::memory_order_relaxed);
+
+		for (;;) {
+			const uint64_t head = _head.load(std::memory_order_acquire);
+
+			if (tail == head)
+				return (false);
+
+			// Producer lapped the consumer, jump to the oldest surviving element
+			if (head - tail > Capacity) {
+				_dropped.fetch_add(head - tail - Capacity, std::memory_order_relaxed);
+				tail = head - Capacity;
+			}
+
+			Slot			&slot = _slots[tail & MASK];
+			const uint64_t	expected = 2 * tail + 2;
+
+			if (slot.seq.load(std::memory_order_acquire) == expected) {
+				T copy = slot.data;
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (slot.seq.load(std::memory_order_relaxed) == expected) {
+					item = copy;
+					_tail.store(tail + 1, std::memory_order_release);
+					return (true);
+				}
+			}
+
+			// Slot is being (or was) overwritten by a newer element, skip it
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			tail++;
+			_tail.store(tail, std::memory_order_release);
+		}
+	}
+
+	/** @brief Returns true if no element is queued (snapshot) */
+	bool	empty() const noexcept {
+		return (size() == 0);
+	}
+
+	/** @brief Number of queued elements, at most Capacity (snapshot) */
+	size_t	size() const noexcept {
+		const uint64_t tail = _tail.load(std::memory_order_acquire);
+		const uint64_t head = _head.load(std::memory_order_acquire);
+		return (head - tail > Capacity ? Capacity : head - tail);
+	}
+
+	/** @brief Number of elements overwritten before the consumer read them */
+	uint64_t	dropped() const noexcept {
+		return (_dropped.load(std::memory_order_relaxed));
+	}
+
+	/** @brief Maximum number of queued elements */
+	static constexpr size_t	capacity() noexcept { return (Capacity); }
+
+private:
+	static constexpr size_t	MASK = Capacity - 1;
+	static constexpr size_t	CACHE_LINE = 64;	/**< Keeps producer and consumer state apart */
+
+	struct Slot {
+		std::atomic<uint64_t>	seq{0};
+		T						data;
+	};
+
+	// Producer owned line
+	alignas(CACHE_LINE) std::atomic<uint64_t>	_head{0};
+
+	// Consumer owned line
+	alignas(CACHE_LINE) std::atomic<uint64_t>	_tail{0};
+	std::atomic<uint64_t>						_dropped{0};
+
+	alignas(CACHE_LINE) Slot					_slots[Capacity];
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @file SeqLockMailbox.hpp
+ * @brief Single-writer "latest value" mailbox protected by a sequence lock.
+ *
+ * The writer never waits: publishing is two counter stores around a copy.
+ * Readers always get the newest published sample in one read, retried only
+ * if the writer published during the copy. Each sample carries a publication
+ * sequence number, so readers can tell how many updates they skipped, and
+ * the receive timestamp given by the writer.
+ *
+ * Exactly one thread may call publish(). Any number of threads may read.
+ */
+template <typename T>
+class SeqLockMailbox {
+
+	static_assert(std::is_trivially_copyable<T>::value,
+		"SeqLockMailbox values must be trivially copyable");
+
+public:
+	/**
+	 * @struct Sample
+	 * @brief Snapshot of the mailbox
+	 */
+	struct Sample {
+		T			value;			/**< Latest published value */
+		uint64_t	sequence;		/**< Publication number, 1 for the first one */
+		int64_t		timestampNs;	/**< Receive time given to publish() */
+	};
+
+	SeqLockMailbox() = default;
+
+	// Shared between threads by address only
+	SeqLockMailbox(const SeqLockMailbox&) = delete;
+	SeqLockMailbox& operator=(const SeqLockMailbox&) = delete;
+
+	/**
+	 * @brief Replaces the stored value (writer side, never blocks)
+	 *
+	 * @param value New value
+	 * @param timestampNs Receive time of the value, in nanoseconds
+	 */
+	void	publish(const T &value, int64_t timestampNs) noexcept {
+
+		const uint64_t	seq = _seq.load(std::memory_order_relaxed);
+
+		// Odd sequence marks a write in progress
+		_seq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		_value = value;
+		_timestampNs = timestampNs;
+		_seq.store(seq + 2, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Reads the newest sample
+	 *
+	 * @param out Output snapshot
+	 * @return true if a value was ever published, false otherwise
+	 */
+	bool	load(Sample &out) const noexcept {
+
+		for (;;) {
+			const uint64_t seq = _seq.load(std::memory_order_acquire);
+
+			if (seq == 0)
+				return (false);
+
+			// Writer was preempted mid update, let it finish
+			if (seq & 1) {
+				std::this_thread::yield();
+				continue ;
+			}
+
+			T		value = _value;
+			int64_t	timestampNs = _timestampNs;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (_seq.load(std::memory_order_relaxed) == seq) {
+				out.value = value;
+				out.sequence = seq / 2;
+				out.timestampNs = timestampNs;
+				return (true);
+			}
+		}
+	}
+
+	/**
+	 * @brief Reads the newest sample only if it was not seen yet
+	 *
+	 * Updates missed since lastSequence are out.sequence - lastSequence - 1.
+	 *
+	 * @param out Output snapshot
+	 * @param lastSequence Sequence of the last sample seen by this reader (0 if none)
+	 * @return true if a newer sample was read, false otherwise
+	 */
+	bool	loadNewer(Sample &out, uint64_t lastSequence) const noexcept {
+
+		if (sequence() <= lastSequence)
+			return (false);
+		return (load(out) && out.sequence > lastSequence);
+	}
+
+	/** @brief Number of publications so far (snapshot) */
+	uint64_t	sequence() const noexcept {
+		return (_seq.load(std::memory_order_acquire) / 2);
+	}
+
+private:
+	std::atomic<uint64_t>	_seq{0};
+	T						_value{};
+	int64_t					_timestampNs = 0;
+};
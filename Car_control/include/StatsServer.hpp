@@ -0,0 +1,106 @@
+#pragma once
+
+#include "LatencyHistogram.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+/**
+ * @file StatsServer.hpp
+ * @brief Local Unix socket serving the registered latency histograms.
+ *
+ * Histograms are registered by name, then a background thread started with
+ * statsStart() answers one command per connection:
+ * - list: registered names, one per line
+ * - show [PREFIX]: count, min, mean, p50, p90, p99, p99.9 and max in us
+ *   of every histogram whose name starts with PREFIX
+ * - dump NAME: "lowNs highNs count" of every non-empty bucket
+ * - help
+ *
+ * The recording threads never see the server: it only reads the relaxed
+ * counters of the histograms. Query it with tools/carstats.cpp.
+ */
+
+#define STATS_SOCKET_PATH		"/tmp/car_control.stats"	/**< Default endpoint (--stats-socket) */
+#define STATS_MAX_HISTOGRAMS	32		/**< Registered histograms at the same time */
+#define STATS_NAME_SIZE			40		/**< Name length, terminator included */
+#define STATS_COMMAND_SIZE		128		/**< Longest command accepted */
+#define STATS_READ_TIMEOUT		std::chrono::milliseconds(200)	/**< A client must send its command within this */
+
+/**
+ * @brief Makes a histogram visible to the endpoint
+ *
+ * @param name Unique name, copied (e.g. "can.tx.0x101")
+ * @param histogram Must stay alive until statsUnregister() or statsStop()
+ * @return 0 if registered, -1 if the name is invalid or taken, or the table is full
+ */
+int		statsRegister(const char *name, const LatencyHistogram *histogram);
+
+/**
+ * @brief Removes every entry of a histogram, waits for a query reading it
+ *
+ * @param histogram Histogram given to statsRegister()
+ */
+void	statsUnregister(const LatencyHistogram *histogram);
+
+/**
+ * @brief Answers one command, what a client receives
+ *
+ * @param command Command line, without the trailing newline
+ * @param out Response, one line per entry
+ * @return 0 if the command was understood, -1 otherwise (out holds the error)
+ */
+int		statsCommand(const std::string &command, std::string &out);
+
+/**
+ * @brief Listens on a Unix socket and starts the server thread
+ *
+ * A stale socket file at path is replaced.
+ *
+ * @param path Socket path
+ * @return 0 if listening, -1 if already running or the socket can't be set up
+ */
+int		statsStart(const char *path);
+
+/**
+ * @brief Stops the server, removes the socket file and clears the registry
+ */
+void	statsStop();
+
+/**
+ * @class StatsSession
+ * @brief Runs the stats endpoint for the lifetime of the object
+ */
+class StatsSession {
+
+public:
+	explicit StatsSession(const std::string &path) {
+		if (!path.empty())
+			statsStart(path.c_str());
+	}
+	~StatsSession() { statsStop(); }
+
+	StatsSession(const StatsSession&) = delete;
+	StatsSession& operator=(const StatsSession&) = delete;
+};
+
+/**
+ * @class StatsRegistration
+ * @brief Registers a histogram for the lifetime of the object
+ *
+ * For histograms owned by a scope, e.g. the executive of a control loop.
+ */
+class StatsRegistration {
+
+public:
+	StatsRegistration(const char *name, const LatencyHistogram *histogram)
+		: _histogram(histogram) { statsRegister(name, histogram); }
+	~StatsRegistration() { statsUnregister(_histogram); }
+
+	StatsRegistration(const StatsRegistration&) = delete;
+	StatsRegistration& operator=(const StatsRegistration&) = delete;
+
+private:
+	const LatencyHistogram	*_histogram;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+/**
+ * @file Trace.hpp
+ * @brief Compile-time switchable latency tracepoints.
+ *
+ * Built with -DENABLE_TRACEPOINTS=ON, every TRACE_* macro stores a 16 byte
+ * record (stage, CAN ID, chain, CLOCK_MONOTONIC time) in a preallocated
+ * buffer owned by the calling thread: no lock, no allocation, no I/O.
+ * Without the option the macros compile to nothing.
+ *
+ * A chain follows one input through the stages: TRACE_BEGIN() opens a new
+ * chain on the calling thread and the following tracepoints of that thread
+ * carry its number. traceDump() writes the buffers as CSV at shutdown and
+ * tools/tracereport.cpp turns them into per stage pair percentiles.
+ */
+
+#define TRACE_MAX_THREADS	8				/**< Threads recording at the same time */
+
+// Records kept per thread (the newest ones), small when no macro records anything
+#ifdef ENABLE_TRACEPOINTS
+# define TRACE_BUFFER_SIZE	(1 << 14)
+#else
+# define TRACE_BUFFER_SIZE	(1 << 8)
+#endif
+
+/**
+ * @enum e_traceStage
+ * @brief Points of the input to bus path
+ */
+enum e_traceStage : uint8_t {
+	TRACE_EVDEV_EVENT,	/**< Kernel time of the joystick SYN_REPORT */
+	TRACE_DECODE,		/**< Report decoded into axes and buttons */
+	TRACE_CAN_WRITE,	/**< write() of the frame returned */
+	TRACE_TX_CONFIRM,	/**< Frame seen back from the bus (TX echo) */
+	TRACE_STAGE_COUNT
+};
+
+/**
+ * @struct s_traceRecord
+ * @brief One tracepoint hit
+ */
+typedef struct s_traceRecord {
+	int64_t		timestampNs;	/**< CLOCK_MONOTONIC */
+	uint32_t	chain;			/**< Chain opened by TRACE_BEGIN(), 0 if none */
+	uint16_t	canId;			/**< Frame ID for CAN stages, 0 otherwise */
+	uint8_t		stage;
+} t_traceRecord;
+
+/** @brief CLOCK_MONOTONIC in nanoseconds, the clock of every tracepoint */
+inline int64_t	traceNowNs() {
+
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec);
+}
+
+/**
+ * @brief Opens a new chain on the calling thread
+ */
+void	traceBegin();
+
+/**
+ * @brief Records a tracepoint in the buffer of the calling thread (hot path)
+ *
+ * @param stage Stage reached
+ * @param canId Frame ID, 0 if not a CAN stage
+ * @param timestampNs CLOCK_MONOTONIC time of the stage
+ */
+void	traceRecord(e_traceStage stage, uint16_t canId, int64_t timestampNs);
+
+/**
+ * @brief Writes every buffer as CSV: thread,stage,canId,chain,timestampNs
+ *
+ * Call it once the recording threads stopped.
+ *
+ * @param path Output file
+ * @return Number of records written, -1 if the file can't be written
+ */
+long	traceDump(const char *path);
+
+/**
+ * @brief Name of a stage, as written by traceDump()
+ */
+const char	*traceStageName(e_traceStage stage);
+
+#ifdef ENABLE_TRACEPOINTS
+# define TRACE_BEGIN()						traceBegin()
+# define TRACE_POINT(stage, canId)			traceRecord(stage, canId, traceNowNs())
+# define TRACE_POINT_AT(stage, canId, ns)	traceRecord(stage, canId, ns)
+#else
+# define TRACE_BEGIN()						((void)0)
+# define TRACE_POINT(stage, canId)			((void)0)
+# define TRACE_POINT_AT(stage, canId, ns)	((void)0)
+#endif
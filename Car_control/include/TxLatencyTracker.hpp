@@ -0,0 +1,157 @@
+#pragma once
+
+#include "LatencyHistogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @file TxLatencyTracker.hpp
+ * @brief Per CAN ID latency from write() to the kernel TX echo.
+ */
+
+#define TX_TRACKED_IDS		8		/**< Distinct IDs with a histogram */
+#define TX_PENDING_PER_ID	16		/**< Unconfirmed sends remembered per ID (power of two) */
+#define TX_ECHO_STALE		std::chrono::milliseconds(100)	/**< An older unconfirmed send is lost once a newer one precedes the echo by this much */
+
+/** Ticket of a send that is not tracked (table full) */
+#define TX_UNTRACKED		UINT64_MAX
+
+/**
+ * @struct s_txLatencyStats
+ * @brief Snapshot of the TX latency of one ID
+ */
+typedef struct s_txLatencyStats {
+	uint16_t	canId;
+	uint64_t	sent;		/**< Sends tracked, failed writes excluded */
+	uint64_t	confirmed;	/**< Sends matched with their echo */
+	uint64_t	lost;		/**< Sends whose echo never came */
+	int64_t		minNs;		/**< 0 if nothing confirmed */
+	int64_t		maxNs;
+	int64_t		meanNs;
+	int64_t		p50Ns;		/**< Within 1/32 above the exact percentile */
+	int64_t		p99Ns;
+} t_txLatencyStats;
+
+/**
+ * @class TxLatencyTracker
+ * @brief Matches sent frames with their TX echo and keeps a LatencyHistogram per ID
+ *
+ * A socket receives the echoes of its own frames in transmission order,
+ * so every echo belongs to the oldest unconfirmed send of its ID. A send
+ * whose echo never arrived is skipped once a newer send of the same ID is
+ * older than the echo by more than TX_ECHO_STALE.
+ *
+ * Any number of threads may call sent() and failed(); confirm() must be
+ * called from a single thread. stats() can be called from any thread at
+ * any time. Nothing allocates after construction. Times are CLOCK_REALTIME
+ * nanoseconds, the clock of socket timestamps.
+ */
+class TxLatencyTracker {
+
+public:
+	TxLatencyTracker() = default;
+
+	TxLatencyTracker(const TxLatencyTracker&) = delete;
+	TxLatencyTracker& operator=(const TxLatencyTracker&) = delete;
+
+	/**
+	 * @brief Registers a send, call it right before write()
+	 *
+	 * @param canId Frame ID
+	 * @param writeNs Current time
+	 * @return Ticket for failed(), TX_UNTRACKED if the ID table is full
+	 */
+	uint64_t	sent(uint16_t canId, int64_t writeNs) noexcept;
+
+	/**
+	 * @brief Withdraws a send whose write() failed, no echo will come
+	 *
+	 * @param canId Frame ID
+	 * @param ticket Value returned by sent()
+	 */
+	void		failed(uint16_t canId, uint64_t ticket) noexcept;
+
+	/**
+	 * @brief Matches an echo with its send and records the latency (single thread)
+	 *
+	 * @param canId Frame ID of the echo
+	 * @param echoNs Kernel timestamp of the echo
+	 * @return true if matched, false if no send is waiting for it
+	 */
+	bool		confirm(uint16_t canId, int64_t echoNs) noexcept;
+
+	/**
+	 * @brief Claims the entry of an ID before its first send
+	 *
+	 * So its histogram exists from the start, e.g. to register it with
+	 * the stats endpoint.
+	 *
+	 * @param canId Frame ID
+	 * @return false if the ID table is full
+	 */
+	bool		track(uint16_t canId) noexcept;
+
+	/**
+	 * @brief Latency histogram of one ID
+	 *
+	 * @param canId Frame ID
+	 * @return nullptr if the ID was never tracked or sent
+	 */
+	const LatencyHistogram	*histogram(uint16_t canId) const noexcept;
+
+	/**
+	 * @brief Snapshot of one ID
+	 *
+	 * @param canId Frame ID
+	 * @param stats Output
+	 * @return false if the ID was never sent
+	 */
+	bool		stats(uint16_t canId, t_txLatencyStats *stats) const noexcept;
+
+	/**
+	 * @brief IDs tracked so far
+	 *
+	 * @param ids Output array
+	 * @param max Capacity of ids
+	 * @return Number of IDs written
+	 */
+	size_t		ids(uint16_t *ids, size_t max) const noexcept;
+
+	/** @brief Echoes with no waiting send (foreign frame or lost ordering) */
+	uint64_t	unmatched() const { return (_unmatched.load(std::memory_order_relaxed)); }
+
+	/**
+	 * @brief Writes one line per ID
+	 *
+	 * @param out Stream to write to
+	 * @param prefix Prepended to every line (e.g. "[CAN TX] ")
+	 */
+	void		report(std::ostream &out, const char *prefix) const;
+
+private:
+	static constexpr int32_t	FREE = -1;
+	static constexpr int64_t	WRITE_FAILED = -1;
+
+	typedef struct s_entry {
+		std::atomic<int32_t>	id{FREE};
+		std::atomic<uint64_t>	sent{0};
+		std::atomic<uint64_t>	failed{0};
+		std::atomic<uint64_t>	confirmed{0};
+		std::atomic<uint64_t>	lost{0};
+		uint64_t				next = 0;		/**< Oldest unconfirmed send, confirm() only */
+		std::atomic<int64_t>	writeNs[TX_PENDING_PER_ID] = {};
+		LatencyHistogram		latency;
+	} t_entry;
+
+	t_entry					_entries[TX_TRACKED_IDS];
+	std::atomic<uint64_t>	_unmatched{0};
+
+	t_entry			*claim(uint16_t canId) noexcept;
+	t_entry			*find(uint16_t canId) noexcept;
+	const t_entry	*find(uint16_t canId) const noexcept;
+	void			record(t_entry &entry, int64_t latencyNs) noexcept;
+};
@@ -1,8 +1,15 @@
 #pragma once
 
+#include "AsyncLogger.hpp"
 #include "CANController.hpp"
+#include "CANDispatcher.hpp"
 #include "CANProtocol.hpp"
+#include "CyclicExecutive.hpp"
+#include "DrivingCommandPublisher.hpp"
 #include "Joystick.hpp"
+#include "SPSCRingBuffer.hpp"
+#include "SeqLockMailbox.hpp"
+#include "StatsServer.hpp"
 
 #include <atomic>
 #include <csignal>
@@ -12,7 +19,6 @@
 #include <chrono>
 #include <fcntl.h>
 #include <iomanip>
-#include <queue>
 #include <mutex>
 
 /**
@@ -42,14 +48,59 @@
 #define R2_BUTTON		9
 #define START_BUTTON	11
 
+// Period of the manual control cycle and of the polling monitor
+#define CONTROL_PERIOD	std::chrono::milliseconds(10)
+
+// Default DRIVING_COMMAND refresh rate (--drive-rate) and minimum frame gap
+#define DRIVE_RATE_HZ		50
+#define DRIVE_MIN_GAP		std::chrono::milliseconds(5)
+
+// Speed silence after which the STM32 is considered dead
+#define STM32_TIMEOUT	std::chrono::milliseconds(600)
+
+// Period of the speed and RX drop reports of the monitor
+#define MONITOR_REPORT_PERIOD	std::chrono::milliseconds(1000)
+
 // Wheel values
 #define WHEEL_CIRCUMFERENCE_M	0.21
 
+// Default real-time profile, cores 0-1 are left to the Dashboard and logging
+#define RT_CONTROL_CPU		3
+#define RT_RX_CPU			2
+#define RT_MONITOR_CPU		2
+#define RT_CONTROL_PRIO		80
+#define RT_RX_PRIO			85
+#define RT_MONITOR_PRIO		90
+
+// Stack touched by every real-time thread at startup
+#define RT_STACK_PREFAULT	(256 * 1024)
+
+/**
+ * @struct s_threadProfile
+ * @brief Scheduling of one thread
+ */
+typedef struct s_threadProfile {
+	int		cpu		= -1;	/**< Core to pin the thread to, -1 to leave it free */
+	int		priority	= 0;	/**< SCHED_FIFO priority (1-99), 0 for SCHED_OTHER */
+} t_threadProfile;
+
+/**
+ * @struct s_rtProfile
+ * @brief Real-time profile applied at startup (--rt options)
+ */
+typedef struct s_rtProfile {
+	bool			enabled = false;	/**< Apply the profile at all */
+	t_threadProfile	control;			/**< Main control loop (manual or autonomous) */
+	t_threadProfile	rx;					/**< canReceiverThread */
+	t_threadProfile	monitor;			/**< monitoringThread */
+} t_rtProfile;
+
 /**
  * @struct s_carControl
  * @brief Aggregates all vehicle control objects and configuration.
  *
- * Contains the CAN controller, joystick, interface name, and operation mode.
+ * Contains the CAN controller, joystick, interface name, operation mode
+ * and real-time profile.
  */
 typedef struct s_carControl {
 
@@ -58,6 +109,12 @@ typedef struct s_carControl {
 	std::string		canInterface;
 	bool			manual;
 	bool			exit;
+	bool			reactor = false;	/**< Single thread epoll mode (--reactor) */
+	int				driveRateHz = DRIVE_RATE_HZ;	/**< DRIVING_COMMAND refresh rate (--drive-rate) */
+	std::string		tracePath;		/**< Tracepoint dump written on exit, empty if none (--trace) */
+	bool			txTimestamps = false;	/**< TX echo latency per ID (--tx-timestamps) */
+	std::string		statsSocket = STATS_SOCKET_PATH;	/**< Stats endpoint, empty if disabled (--stats-socket) */
+	t_rtProfile		rt;
 } t_carControl;
 
 /**
@@ -67,6 +124,7 @@ typedef struct s_carControl {
 typedef struct s_speedData {
 	uint16_t	rpm;
 	uint16_t	speedMps;
+	int64_t		timestampNs = 0;	/**< Kernel receive time of the frame, steady_clock */
 } t_speedData;
 
 /**
@@ -76,22 +134,89 @@ typedef struct s_speedData {
 typedef struct s_batteryData {
 	uint16_t	voltage;
 	uint8_t		percentage;
+	int64_t		timestampNs = 0;	/**< Kernel receive time of the frame, steady_clock */
 } t_batteryData;
 
+// Receiver queue depths (power of two), full queues overwrite the oldest sample
+#define SPEED_QUEUE_SIZE	16
+#define BATTERY_QUEUE_SIZE	8
+
+// Latest value snapshots, with publication sequence and receive timestamp
+typedef SeqLockMailbox<t_speedData>::Sample		t_speedSample;
+typedef SeqLockMailbox<t_batteryData>::Sample	t_batterySample;
+
 /**
  * @struct s_CANReceiver
- * @brief Central CAN message receiver with thread-safe queues
+ * @brief Central CAN message receiver with lock-free queues and mailboxes
+ *
+ * Each queue has exactly one producer (canReceiverThread) and one consumer,
+ * and is only fed when queueSamples is set. Mailboxes hold only the newest
+ * sample and can be read from any thread.
+ * Their timing is recorded in the histograms below, see registerReceiverStats().
  */
 typedef struct s_CANReceiver {
-	std::queue<t_speedData>		speedQueue;
-	std::queue<t_batteryData>	batteryQueue;
+	SPSCRingBuffer<t_speedData, SPEED_QUEUE_SIZE>		speedQueue;
+	SPSCRingBuffer<t_batteryData, BATTERY_QUEUE_SIZE>	batteryQueue;
+
+	bool	queueSamples = false;	/**< Feed the queues, set before starting canReceiverThread */
 
-	std::mutex speedMutex;
-	std::mutex batteryMutex;
+	SeqLockMailbox<t_speedData>		speedMailbox;
+	SeqLockMailbox<t_batteryData>	batteryMailbox;
+
+	CANDispatcher	dispatcher;	/**< Per-ID decoders, filled by registerReceiverHandlers() */
+
+	std::atomic<uint32_t>	rxDrops{0};	/**< Frames dropped by the kernel (SO_RXQ_OVFL) */
+
+	// Kernel receive time between two frames, recorded by the producer
+	LatencyHistogram	speedInterArrival;
+	LatencyHistogram	batteryInterArrival;
+	int64_t				lastSpeedNs = 0;		/**< Producer only, 0 before the first frame */
+	int64_t				lastBatteryNs = 0;
+
+	// Kernel receive time to the consumer read, queues and mailboxes
+	LatencyHistogram	speedDwell;		/**< getSpeedData() */
+	LatencyHistogram	batteryDwell;	/**< getBatteryData() */
+	LatencyHistogram	speedAge;		/**< getLatestSpeed() */
+	LatencyHistogram	batteryAge;		/**< getLatestBattery() */
 
 	CANController*	can;
 } t_CANReceiver;
 
+/**
+ * @struct s_manualState
+ * @brief State of the manual control cycle
+ */
+typedef struct s_manualState {
+	t_carControl		*carControl;
+	CyclicExecutive		*executive;		/**< Stopped on START, nullptr in reactor mode */
+	DrivingCommandPublisher	*publisher;	/**< Rate limits and refreshes the driving commands */
+	int64_t				holdCycles;		/**< Remaining cycles of the A button brake hold */
+	bool				stm32Held;		/**< Commands held while g_stm32Lost, resent once cleared */
+} t_manualState;
+
+/**
+ * @struct s_autonomousState
+ * @brief State of the autonomous control cycle
+ */
+typedef struct s_autonomousState {
+	const t_carControl	*carControl;
+	CyclicExecutive		*executive;		/**< Stopped on exit, nullptr in reactor mode */
+	bool				kernelTimed;	/**< Brake repeated by CAN_BCM */
+} t_autonomousState;
+
+/**
+ * @struct s_monitorState
+ * @brief STM32 liveness tracking shared by the monitor thread and the reactor
+ */
+typedef struct s_monitorState {
+	t_CANReceiver	*receiver			= nullptr;
+	bool			stm32Alive			= false;
+	bool			firstSpeedReceived	= false;
+	uint32_t		lastRxDrops			= 0;
+	uint64_t		lastSpeedSequence	= 0;
+	std::chrono::steady_clock::time_point	lastSpeedDataReceived;	/**< Polling fallback only */
+} t_monitorState;
+
 /**
  * @brief Initialize a CAN controller instance.
  *
@@ -119,6 +244,14 @@ t_carControl	initCarControl(int argc, char *argv[]);
  * Supported options:
  * - --manual=true|false
  * - --can=INTERFACE
+ * - --reactor=true|false
+ * - --drive-rate=HZ (1-1000)
+ * - --trace=PATH
+ * - --tx-timestamps=true|false
+ * - --stats-socket=PATH|none
+ * - --rt=true|false
+ * - --rt-cpus=CONTROL,RX,MONITOR (-1 leaves a thread unpinned)
+ * - --rt-prio=CONTROL,RX,MONITOR (0 keeps SCHED_OTHER)
  * - --help or -h
  *
  * @param argc Argument count
@@ -129,10 +262,39 @@ t_carControl	initCarControl(int argc, char *argv[]);
 int	parsingArgv(int argc, char *argv[],
 		t_carControl *carControl);
 
+/**
+ * @brief Locks the process memory for the real-time profile
+ *
+ * Calls mlockall(MCL_CURRENT | MCL_FUTURE) so no page fault can stall a
+ * control thread later, and pre-faults the calling thread stack. Logs the
+ * outcome; missing privileges only disable the lock.
+ *
+ * @param profile Profile parsed from the command line
+ * @return 1 if memory is locked, 0 if disabled or not permitted
+ */
+int		applyProcessProfile(const t_rtProfile &profile);
+
+/**
+ * @brief Applies a thread profile to the calling thread
+ *
+ * Pins the thread, switches it to SCHED_FIFO and pre-faults
+ * RT_STACK_PREFAULT bytes of its stack. Must run on the thread itself.
+ * Logs the resulting configuration; a refused setting (e.g. EPERM without
+ * CAP_SYS_NICE) is logged and the thread keeps running with the default.
+ *
+ * @param name Thread label for the log
+ * @param profile Core and priority to apply
+ * @return 1 if everything was applied, 0 if something fell back
+ */
+int		applyThreadProfile(const char *name, const t_threadProfile &profile);
+
 /**
  * @brief Main loop for manual joystick control.
  *
  * Aggregates joystick outputs, stabilizes values, and sends CAN frames.
+ * Sleeps until the joystick has events, with a CONTROL_PERIOD task on the
+ * same CyclicExecutive for the brake hold, until shutdown. Driving commands
+ * go through a DrivingCommandPublisher refreshed at driveRateHz.
  *
  * @param carControl Pointer to t_carControl containing CAN and joystick
  */
@@ -141,12 +303,70 @@ void	manualLoop(t_carControl *carControl);
 /**
  * @brief Main loop for autonomous operation.
  *
- * Sends emergency brake commands periodically and reads CAN bus messages.
+ * Keeps the emergency brake engaged, repeated by the kernel every
+ * CANProtocol::BRAKE_REPEAT_PERIOD, until shutdown. Runs on a CyclicExecutive
+ * with the same period.
  *
  * @param carControl Reference to t_carControl
  */
 void	autonomousLoop(const t_carControl &carControl);
 
+/**
+ * @brief Builds the driving command publisher configuration of carControl
+ *
+ * @param carControl Parsed car control (driveRateHz)
+ * @return Refresh period of 1 / driveRateHz and a DRIVE_MIN_GAP gap
+ */
+t_publisherConfig	drivingPublisherConfig(const t_carControl &carControl);
+
+/**
+ * @brief Refreshes the driving command when due (CyclicExecutive task)
+ *
+ * @param ctx Pointer to t_manualState
+ */
+void	manualPublish(void *ctx);
+
+/**
+ * @brief One manual control cycle (CyclicExecutive task)
+ *
+ * Counts down the A button brake hold, then runs manualInput().
+ *
+ * @param ctx Pointer to t_manualState
+ */
+void	manualCycle(void *ctx);
+
+/**
+ * @brief Consumes pending joystick events and sends the axes if they moved
+ *
+ * Buttons are handled during a brake hold, the axes are not sent.
+ * Called when the joystick descriptor is readable (CyclicExecutive input).
+ *
+ * @param ctx Pointer to t_manualState
+ */
+void	manualInput(void *ctx);
+
+/**
+ * @brief One autonomous control cycle (CyclicExecutive task)
+ *
+ * @param ctx Pointer to t_autonomousState
+ */
+void	autonomousCycle(void *ctx);
+
+/**
+ * @brief Single threaded control plane (--reactor)
+ *
+ * Replaces manualLoop/autonomousLoop, canReceiverThread and monitoringThread
+ * with one epoll set: the CAN RX socket, the CAN_BCM watch, the joystick,
+ * a CONTROL_PERIOD timerfd and a signalfd for SIGINT/SIGTERM. Events are
+ * handled in arrival order on the calling thread, so nothing is shared
+ * across threads.
+ *
+ * @param carControl Initialized car control (CAN and, in manual mode, joystick)
+ * @param receiver Receiver prepared with initCANReceiver()
+ * @return 0 on shutdown, -1 if a descriptor could not be set up
+ */
+int		reactorLoop(t_carControl *carControl, t_CANReceiver *receiver);
+
 /**
  * @brief Sets up signal handling for graceful shutdown (SIGINT, SIGTERM)
  */
@@ -162,34 +382,135 @@ void	signalHandler(int signum);
 /**
  * @brief Converts raw RPM into meters per second
  *
- * @param can Reference raw RPM message received from stm32
+ * Called by the speed decoder for every frame.
+ *
+ * @param rpm Raw RPM received from the STM32
+ * @return Speed in m/s, truncated
  */
 uint16_t	rpmToSpeedMps(uint16_t rpm);
 
+/**
+ * @brief Registers the decoder of every STM32 message in receiver->dispatcher
+ *
+ * Registers the onFrame() hook of every message dbc/vehicle.dbc lists as
+ * received by RPI, the kernel receive filter follows the registered IDs.
+ *
+ * @param receiver Pointer to CANReceiver structure
+ * @return 0 if successful, -1 if a registration failed
+ */
+int		registerReceiverHandlers(t_CANReceiver* receiver);
+
+/**
+ * @brief Prepares the CAN receiver and subscribes the RX socket to its IDs
+ *
+ * Registers the receive handlers and installs a kernel filter matching
+ * exactly the registered IDs.
+ *
+ * @param receiver Pointer to CANReceiver structure to initialize
+ * @param can Initialized CAN controller
+ * @return 1 if successful, 0 on error
+ */
+int		initCANReceiver(t_CANReceiver* receiver, CANController* can);
+
+/**
+ * @brief Publishes the receiver histograms on the stats endpoint
+ *
+ * can.rx.*.interarrival, mailbox.*.age, queue.*.dwell if queueSamples
+ * is set, plus can.tx.0xID for every ID tracked with --tx-timestamps.
+ *
+ * @param receiver Receiver prepared with initCANReceiver(), must outlive the registration
+ * @return Number of histograms registered
+ */
+int		registerReceiverStats(t_CANReceiver* receiver);
+
 /**
  * @brief CAN receiver thread - reads all CAN messages and distributes to queues
+ *
+ * Sleeps in the kernel until frames arrive and drains everything that is
+ * ready with a single recvmmsg() call, so the bus can be followed at full
+ * load. Frames are routed through receiver->dispatcher. Kernel-side drops
+ * are published in receiver->rxDrops.
  * 
  * @param receiver Pointer to CANReceiver structure
  */
 void	canReceiverThread(t_CANReceiver* receiver);
 
 /**
- * @brief Monitoring thread - sends heartbeat and monitors STM32 health via speed data
+ * @brief Monitoring thread - monitors STM32 health via speed data
  * 
- * This thread sends EMERGENCY_BRAKE(false) as a heartbeat signal every 300ms.
+ * The EMERGENCY_BRAKE(false) heartbeat is sent every 300ms by the kernel
+ * (CANProtocol::startCyclicBrake() in main), not by this thread.
  * It monitors STM32 health by checking if speed sensor data is being received.
  * 
  * Since STM32 cannot efficiently send dedicated ACK due to single-core limitations,
  * we use the reception of sensor speed data (which STM32 sends anyway) as implicit 
  * proof of life.
+ *
+ * The 600ms silence is detected by a kernel CAN_BCM watch on the speed ID, so
+ * the thread sleeps until the STM32 goes silent or comes back and otherwise
+ * only wakes once per second to report. Without CAN_BCM it falls back to
+ * polling the speed mailbox every CONTROL_PERIOD on a CyclicExecutive, and
+ * also if the watch fails later on. Returns once g_running is cleared and the
+ * controller is woken up.
+ *
+ * A lost STM32 gets one emergency brake and sets g_stm32Lost, which holds
+ * the driving commands of manualLoop. Speed data clears it again. The
+ * EMERGENCY_BRAKE(false) heartbeat keeps running in both states.
  * 
  * @param receiver Pointer to CANReceiver structure with queues and CAN controller
  */
 void monitoringThread(t_CANReceiver* receiver);
 
 /**
- * @brief Get latest speed data from queue (non-blocking)
+ * @brief Asks the kernel to report STM32 silence (CAN_BCM watch on the speed ID)
+ *
+ * @param can Initialized CAN controller
+ * @return true if watched, false if the caller must poll with monitorPoll()
+ */
+bool	watchStm32(CANController *can);
+
+/**
+ * @brief Handles a CAN_BCM event of the speed ID watch
+ *
+ * @param state Monitor state
+ * @param event RX_CHANGED or RX_TIMEOUT
+ */
+void	monitorEvent(t_monitorState *state, uint32_t event);
+
+/**
+ * @brief One polling cycle of the monitor, used without CAN_BCM (CyclicExecutive task)
+ *
+ * @param ctx Pointer to t_monitorState
+ */
+void	monitorPoll(void *ctx);
+
+/**
+ * @brief Reports the newest speed sample and new kernel RX drops
+ *
+ * @param state Monitor state
+ * @return true if a new speed sample was seen
+ */
+bool	monitorReport(t_monitorState *state);
+
+/**
+ * @brief Routes a received batch through receiver->dispatcher
+ *
+ * Every frame is stamped with its kernel receive time converted to
+ * steady_clock, or with the dispatch time if the socket gave none.
+ * Also publishes the kernel drop counter in receiver->rxDrops.
+ *
+ * @param receiver Pointer to CANReceiver structure
+ * @param batch Batch filled by CANController::receiveBatch()
+ * @param count Number of frames in the batch
+ */
+void	dispatchRxBatch(t_CANReceiver* receiver, const t_canRxBatch *batch, int count);
+
+/**
+ * @brief Get oldest queued speed data (non-blocking, lock-free)
  * 
+ * Must only be called from a single consumer thread, and only receives
+ * samples if receiver->queueSamples was set.
+ *
  * @param receiver Pointer to CANReceiver
  * @param data Output speed data
  * @return true if data available, false if queue empty
@@ -197,17 +518,52 @@ void monitoringThread(t_CANReceiver* receiver);
 bool	getSpeedData(t_CANReceiver* receiver, t_speedData* data);
 
 /**
- * @brief Get latest battery data from queue (non-blocking)
+ * @brief Get oldest queued battery data (non-blocking, lock-free)
  * 
+ * Must only be called from a single consumer thread, and only receives
+ * samples if receiver->queueSamples was set.
+ *
  * @param receiver Pointer to CANReceiver
  * @param data Output battery data
  * @return true if data available, false if queue empty
  */
 bool	getBatteryData(t_CANReceiver* receiver, t_batteryData* data);
 
+/**
+ * @brief Get the newest speed sample if it was not seen yet (lock-free, any thread)
+ *
+ * Updates skipped since the previous call are
+ * sample->sequence - previous *lastSequence - 1.
+ *
+ * @param receiver Pointer to CANReceiver
+ * @param sample Output snapshot (value, sequence, receive timestamp)
+ * @param lastSequence In/out sequence of the last sample seen by the caller, 0 initially
+ * @return true if a newer sample was read, false otherwise
+ */
+bool	getLatestSpeed(t_CANReceiver* receiver, t_speedSample* sample,
+			uint64_t* lastSequence);
+
+/**
+ * @brief Get the newest battery sample if it was not seen yet (lock-free, any thread)
+ *
+ * @param receiver Pointer to CANReceiver
+ * @param sample Output snapshot (value, sequence, receive timestamp)
+ * @param lastSequence In/out sequence of the last sample seen by the caller, 0 initially
+ * @return true if a newer sample was read, false otherwise
+ */
+bool	getLatestBattery(t_CANReceiver* receiver, t_batterySample* sample,
+			uint64_t* lastSequence);
+
 /**
  * @brief Global atomic flag controlling main loops.
  *
  * Set to false to terminate manualLoop or autonomousLoop safely.
  */
 extern std::atomic<bool> g_running;
+
+/**
+ * @brief Set by monitoringThread while the STM32 is silent.
+ *
+ * manualLoop sends no driving command while it is set.
+ */
+extern std::atomic<bool> g_stm32Lost;
@@ -9,7 +9,9 @@ extern "C" {
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <errno.h>
 #include <poll.h>
+#include <time.h>
 
 #include <net/if.h>
 
@@ -18,6 +20,51 @@ extern "C" {
 
 #include <linux/can.h>
 #include <linux/can/raw.h>
+#include <linux/can/bcm.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+/** Maximum number of frames drained by a single can_receive_batch() call */
+#define CAN_RX_BATCH_SIZE	32
+
+/** Maximum number of IDs accepted by can_set_filters() */
+#define CAN_MAX_FILTERS		64
+
+/**
+ * SO_PRIORITY used for safety frames, highest value allowed without CAP_NET_ADMIN.
+ * Only honoured by a priority aware qdisc such as pfifo_fast, see scripts/setup_can_qdisc.sh
+ */
+#define CAN_PRIORITY_EMERGENCY	6
+
+/** Returned by every blocking receive when the wakeup descriptor was signaled */
+#define CAN_RX_WAKEUP		-2
+
+/** Returned by can_receive_timeout() and can_bcm_receive() when the timeout expired */
+#define CAN_RX_TIMEOUT		-3
+
+/** Back off after a socket error when the receive call has no timeout */
+#define CAN_RX_ERROR_BACKOFF_MS	100
+
+/** SO_TIMESTAMPING flags of can_enable_tx_echo(): software receive time of every frame */
+#define CAN_TX_TIMESTAMPING	(SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE)
+
+/**
+ * @struct s_canRxBatch
+ * @brief Preallocated buffers for batched reception with recvmmsg()
+ *
+ * Must be prepared once with can_rx_batch_init() and can then be reused
+ * for every receive without further allocation.
+ */
+typedef struct s_canRxBatch {
+	struct can_frame	frames[CAN_RX_BATCH_SIZE];		/**< Received frames */
+	struct mmsghdr		msgs[CAN_RX_BATCH_SIZE];		/**< recvmmsg() headers */
+	struct iovec		iov[CAN_RX_BATCH_SIZE];			/**< One iovec per frame */
+	char				control[CAN_RX_BATCH_SIZE]
+							[CMSG_SPACE(sizeof(uint32_t))
+							+ CMSG_SPACE(sizeof(struct scm_timestamping))];	/**< Ancillary data */
+	int64_t				timestampsNs[CAN_RX_BATCH_SIZE];	/**< Kernel receive time (CLOCK_REALTIME), 0 if not timestamped */
+	uint32_t			drops;	/**< Kernel drop counter (SO_RXQ_OVFL), cumulative */
+} t_canRxBatch;
 
 
 /**
@@ -46,6 +93,142 @@ int		check_mtu_support(int s, struct ifreq *ifr);
  */
 int		socketCan_init(const char *interface);
 
+/**
+ * @brief Opens one more socket on an interface already checked by socketCan_init
+ *
+ * Same as socketCan_init() without the MTU check, so a controller that
+ * needs several sockets on one interface validates (and logs) it once.
+ *
+ * @param interface Name of the CAN interface (e.g., "can0")
+ * @return Socket file descriptor on success, -1 on failure
+ */
+int		socketCan_open(const char *interface);
+
+/**
+ * @brief Opens a broadcast manager (CAN_BCM) socket connected to an interface
+ *
+ * The kernel then owns the timing of cyclic frames configured with
+ * can_bcm_tx_setup(). Every cyclic transmission of the socket stops when
+ * it is closed, including when the process dies.
+ *
+ * @param interface Name of the CAN interface (e.g., "can0")
+ * @return Socket file descriptor on success, -1 on failure
+ */
+int		socketCan_bcm_open(const char *interface);
+
+/**
+ * @brief Starts (or restarts) kernel-timed cyclic transmission of a frame
+ *
+ * The first frame is sent immediately, then every period_us microseconds
+ * until can_bcm_tx_delete() or close. Calling it again for the same ID
+ * replaces the payload and the period.
+ *
+ * @param socket Socket returned by socketCan_bcm_open
+ * @param frame Frame to repeat, its can_id identifies the cyclic job
+ * @param period_us Transmission period in microseconds (> 0)
+ * @return 0 if successful, -1 on error
+ */
+int		can_bcm_tx_setup(int socket, const struct can_frame *frame,
+					uint32_t period_us);
+
+/**
+ * @brief Replaces the payload of a cyclic frame without touching its timer
+ *
+ * The kernel swaps the frame between two transmissions, so the bus never
+ * sees a partially updated payload. If no cyclic job exists yet for the
+ * ID, an idle one is created and nothing is sent until can_bcm_tx_setup().
+ *
+ * @param socket Socket returned by socketCan_bcm_open
+ * @param frame New content, its can_id identifies the cyclic job
+ * @param send_now Non zero to also send the new content right away
+ * @return 0 if successful, -1 on error
+ */
+int		can_bcm_tx_update(int socket, const struct can_frame *frame,
+					int send_now);
+
+/**
+ * @brief Stops and removes the cyclic transmission of an ID
+ *
+ * @param socket Socket returned by socketCan_bcm_open
+ * @param can_id Identifier of the cyclic job
+ * @return 0 if successful, -1 on error (e.g. no job for this ID)
+ */
+int		can_bcm_tx_delete(int socket, uint16_t can_id);
+
+/**
+ * @brief Asks the kernel to watch an ID and report when it stops or resumes
+ *
+ * Installs a CAN_BCM RX_SETUP with an empty content mask, so regular
+ * traffic on the ID never wakes the reader. The socket becomes readable
+ * with RX_CHANGED for the first frame, RX_TIMEOUT once no frame was seen
+ * for timeout_us, then RX_CHANGED again for the first frame after a
+ * timeout. The timer only starts with the first frame.
+ *
+ * @param socket Socket returned by socketCan_bcm_open
+ * @param can_id 11-bit CAN identifier to watch
+ * @param timeout_us Silence reported as RX_TIMEOUT, in microseconds (> 0)
+ * @return 0 if successful, -1 on error
+ */
+int		can_bcm_rx_setup(int socket, uint16_t can_id, uint32_t timeout_us);
+
+/**
+ * @brief Receives the next broadcast manager notification
+ *
+ * Sleeps in the kernel like can_receive_timeout().
+ *
+ * @param socket Socket returned by socketCan_bcm_open
+ * @param opcode Notification type, RX_CHANGED or RX_TIMEOUT
+ * @param frame Frame that triggered RX_CHANGED, zeroed for RX_TIMEOUT (may be NULL)
+ * @param timeout_ms Maximum time to wait in milliseconds (-1 waits forever)
+ * @param wake_fd Descriptor that interrupts the wait when readable (-1 to disable)
+ * @return 0 if a notification was read, CAN_RX_TIMEOUT, CAN_RX_WAKEUP, -1 on error
+ */
+int		can_bcm_receive(int socket, uint32_t *opcode, struct can_frame *frame,
+					int timeout_ms, int wake_fd);
+
+/**
+ * @brief Restricts reception to an exact list of standard CAN IDs
+ *
+ * Installs CAN_RAW_FILTER entries so the kernel discards every other
+ * frame before it reaches user space. Extended and RTR frames are always
+ * rejected. An empty list disables reception entirely on this socket.
+ * Sending is not affected.
+ *
+ * @param socket CAN socket
+ * @param ids Array of 11-bit CAN identifiers to accept
+ * @param count Number of entries in ids (max CAN_MAX_FILTERS)
+ * @return 0 if successful, -1 on error
+ */
+int		can_set_filters(int socket, const uint16_t *ids, size_t count);
+
+/**
+ * @brief Attaches the kernel receive time to every frame (SO_TIMESTAMPNS)
+ *
+ * can_receive_batch() then fills batch->timestampsNs with the time the
+ * frame reached the CAN stack, before any user-space scheduling delay.
+ *
+ * @param socket CAN socket
+ * @return 0 if successful, -1 on error
+ */
+int		can_enable_rx_timestamps(int socket);
+
+/**
+ * @brief Makes a TX socket receive the echo of its own frames, timestamped
+ *
+ * Enables CAN_RAW_RECV_OWN_MSGS and software SO_TIMESTAMPING, and restricts
+ * reception to the given IDs. The echo of a frame sent by this socket is
+ * received with MSG_CONFIRM in its msg_flags; for drivers that echo on
+ * transmit completion its kernel timestamp is the time the frame left the
+ * controller. Frames of the same IDs sent by other local sockets are
+ * received too, without MSG_CONFIRM.
+ *
+ * @param socket Socket returned by socketCan_init or socketCan_open
+ * @param ids IDs sent on this socket
+ * @param count Number of entries in ids (max CAN_MAX_FILTERS)
+ * @return 0 if successful, -1 on error
+ */
+int		can_enable_tx_echo(int socket, const uint16_t *ids, size_t count);
+
 /**
  * @brief Sends a standard CAN frame (8 bytes max)
  *
@@ -58,6 +241,30 @@ int		socketCan_init(const char *interface);
 int		can_send_frame(int socket, uint16_t can_id, 
 					const int8_t* data, uint8_t len);
 
+/**
+ * @brief Writes an already built classical CAN frame as is
+ *
+ * No validation, copy or logging is done, intended for prebuilt frames on
+ * latency critical paths.
+ *
+ * @param socket Socket returned by socketCan_init
+ * @param frame Fully initialized frame to send
+ * @return 0 if successful, -1 on error
+ */
+int		can_send_prebuilt(int socket, const struct can_frame *frame);
+
+/**
+ * @brief Sets the socket priority used by the interface queueing discipline
+ *
+ * Frames from a higher priority socket are dequeued first by the default
+ * pfifo_fast qdisc, ahead of lower priority traffic waiting in the TX queue.
+ *
+ * @param socket Socket returned by socketCan_init
+ * @param priority SO_PRIORITY value (0-6 without CAP_NET_ADMIN)
+ * @return 0 if successful, -1 on error
+ */
+int		can_set_priority(int socket, int priority);
+
 /**
  * @brief Sends a CAN-FD frame (up to 64 bytes)
  *
@@ -79,6 +286,51 @@ int		can_send_frame_fd(int socket, uint16_t can_id,
  */
 int		can_try_receive(int socket, struct can_frame *frame);
 
+/**
+ * @brief Receives a standard CAN frame, sleeping in the kernel until one arrives
+ *
+ * Waits on the CAN socket and, optionally, on a wakeup descriptor
+ * (eventfd/pipe) used to interrupt the wait on shutdown.
+ *
+ * @param socket CAN socket
+ * @param frame Pointer to can_frame struct to store received data
+ * @param timeout_ms Maximum time to wait in milliseconds (-1 waits forever)
+ * @param wake_fd Descriptor that interrupts the wait when readable (-1 to disable)
+ * On a socket error (POLLERR/POLLHUP) the error is consumed and reported,
+ * then the call sleeps for the timeout before returning -1 with errno set.
+ *
+ * @return 0 if a frame was read, CAN_RX_TIMEOUT, CAN_RX_WAKEUP, -1 on error
+ */
+int		can_receive_timeout(int socket, struct can_frame *frame,
+					int timeout_ms, int wake_fd);
+
+/**
+ * @brief Links the frame, iovec and control buffers of a batch together
+ *
+ * @param batch Batch to prepare, reusable for any number of receives
+ */
+void	can_rx_batch_init(t_canRxBatch *batch);
+
+/**
+ * @brief Receives every frame that is ready with a single recvmmsg() call
+ *
+ * Sleeps in the kernel until at least one frame is available (or the
+ * timeout/wakeup fires), then drains up to CAN_RX_BATCH_SIZE frames.
+ * The kernel drop counter reported through SO_RXQ_OVFL is stored in
+ * batch->drops, and the kernel receive time of each frame (SO_TIMESTAMPNS
+ * or SO_TIMESTAMPING) in batch->timestampsNs.
+ *
+ * @param socket CAN socket
+ * @param batch Buffers prepared with can_rx_batch_init()
+ * @param timeout_ms Maximum time to wait in milliseconds (-1 waits forever)
+ * @param wake_fd Descriptor that interrupts the wait when readable (-1 to disable)
+ * Socket errors are handled like in can_receive_timeout().
+ *
+ * @return Number of frames read, 0 on timeout, CAN_RX_WAKEUP if woken up, -1 on error
+ */
+int		can_receive_batch(int socket, t_canRxBatch *batch,
+					int timeout_ms, int wake_fd);
+
 /**
  * @brief Attempts to receive a CAN-FD frame (non-blocking)
  *
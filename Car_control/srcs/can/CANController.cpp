@@ -1,10 +1,15 @@
 #include "CANController.hpp"
+#include "Trace.hpp"
 
 // Constructor
 CANController::CANController(const std::string &interface) 
 	: _interface(interface) {
 
 	_socket = -1;
+	_rxSocket = -1;
+	_prioritySocket = -1;
+	_wakeFd = -1;
+	_bcmSocket = -1;
 	_initialized = false;
 	initialize();
 }
@@ -17,10 +22,20 @@ CANController::~CANController() {
 // Move Constructor
 CANController::CANController(CANController&& other) noexcept
 	: _socket(other._socket)
+	, _rxSocket(other._rxSocket)
+	, _prioritySocket(other._prioritySocket)
+	, _wakeFd(other._wakeFd)
+	, _bcmSocket(other._bcmSocket)
 	, _interface(std::move(other._interface))
-	, _initialized(other._initialized) {
+	, _initialized(other._initialized)
+	, _txLatency(std::move(other._txLatency))
+	, _echoBatch(std::move(other._echoBatch)) {
 
 	other._socket = -1;
+	other._rxSocket = -1;
+	other._prioritySocket = -1;
+	other._wakeFd = -1;
+	other._bcmSocket = -1;
 	other._initialized = false;
 }
 
@@ -30,10 +45,20 @@ CANController& CANController::operator=(CANController&& other) noexcept {
 	if (this != &other) {
 		cleanup();
 		_socket = other._socket;
+		_rxSocket = other._rxSocket;
+		_prioritySocket = other._prioritySocket;
+		_wakeFd = other._wakeFd;
+		_bcmSocket = other._bcmSocket;
 		_interface = std::move(other._interface);
 		_initialized = other._initialized;
+		_txLatency = std::move(other._txLatency);
+		_echoBatch = std::move(other._echoBatch);
 		
 		other._socket = -1;
+		other._rxSocket = -1;
+		other._prioritySocket = -1;
+		other._wakeFd = -1;
+		other._bcmSocket = -1;
 		other._initialized = false;
 	}
 	return (*this);
@@ -48,44 +73,253 @@ void	CANController::initialize() {
 		return ;
 	}
 
+	// TX and RX use separate sockets so a send never waits behind a receive
 	_socket = socketCan_init(_interface.c_str());
 	if (_socket < 0) {
 		throw CANException("Failed to initialize interface: "
 		+ _interface);
 	}
+
+	// TX socket never reads, keep bus traffic out of its receive queue
+	_rxSocket = socketCan_open(_interface.c_str());
+	if (_rxSocket < 0 || can_set_filters(_socket, nullptr, 0) < 0) {
+		cleanupSockets();
+		throw CANException("Failed to initialize RX socket on: "
+		+ _interface);
+	}
+
+	// Kernel receive times, samples fall back to the dispatch time without them
+	if (can_enable_rx_timestamps(_rxSocket) < 0)
+		std::cerr << "RX timestamps unavailable on " << _interface << std::endl;
+
+	// Safety frames get their own socket, TX queue position and priority
+	_prioritySocket = socketCan_open(_interface.c_str());
+	if (_prioritySocket < 0 || can_set_filters(_prioritySocket, nullptr, 0) < 0
+		|| can_set_priority(_prioritySocket, CAN_PRIORITY_EMERGENCY) < 0) {
+		cleanupSockets();
+		throw CANException("Failed to initialize priority socket on: "
+		+ _interface);
+	}
+
+	_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_wakeFd < 0) {
+		cleanupSockets();
+		throw CANException("Failed to create wakeup eventfd for: "
+		+ _interface);
+	}
+
+	// Cyclic frames are optional (can-bcm module), everything else works without
+	_bcmSocket = socketCan_bcm_open(_interface.c_str());
+	if (_bcmSocket < 0)
+		std::cerr << "CAN_BCM unavailable on " << _interface
+		<< ", cyclic frames disabled" << std::endl;
 	_initialized = true;
 }
 
 void	CANController::cleanup() {
 	
-	if (_initialized && _socket >= 0) {
+	cleanupSockets();
+	_initialized = false;
+	_txLatency.reset();
+	_echoBatch.reset();
+}
+
+// Releases every descriptor still owned, used on partial init failures too
+void	CANController::cleanupSockets() {
+
+	if (_socket >= 0) {
 		can_close(_socket);
 		_socket = -1;
-		_initialized = false;
 	}
+	if (_rxSocket >= 0) {
+		can_close(_rxSocket);
+		_rxSocket = -1;
+	}
+	if (_prioritySocket >= 0) {
+		can_close(_prioritySocket);
+		_prioritySocket = -1;
+	}
+	if (_wakeFd >= 0) {
+		close(_wakeFd);
+		_wakeFd = -1;
+	}
+	if (_bcmSocket >= 0) {
+		can_close(_bcmSocket);
+		_bcmSocket = -1;
+	}
+}
+
+// Kernel-side RX filter, only subscribed IDs cross into user space
+void	CANController::setReceiveFilter(const uint16_t *ids, size_t count) {
+
+	if (!_initialized)
+		throw CANException("CAN not initialized");
+
+	if (can_set_filters(_rxSocket, ids, count) < 0)
+		throw CANException("Failed to install receive filter on: "
+		+ _interface);
+}
+
+// Same clock as the socket timestamps of the echoes
+static int64_t	realtimeNs() {
+
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec);
 }
 
 // TX handler sending frames in classic CAN format
 void	CANController::sendFrame(uint16_t can_id, 
 			const int8_t* data, uint8_t len) {
 
-	std::lock_guard<std::mutex> lock(_mutex);
-
 	if (!_initialized)
 		throw CANException("CAN not initialized");
-	
+
+	uint64_t	ticket = _txLatency ? _txLatency->sent(can_id, realtimeNs()) : TX_UNTRACKED;
+
 	if (can_send_frame(_socket, can_id, data, len) < 0) {
+		if (_txLatency)
+			_txLatency->failed(can_id, ticket);
 		throw CANException("Failed to send frame (ID: 0x" +
 		std::to_string(can_id) + ")");
 	}
+	TRACE_POINT(TRACE_CAN_WRITE, can_id);
+}
+
+// Emergency path: prebuilt frame, dedicated socket, no lock, no throw
+int		CANController::sendPriorityFrame(const struct can_frame &frame) noexcept {
+
+	uint16_t	id = static_cast<uint16_t>(frame.can_id & CAN_SFF_MASK);
+	uint64_t	ticket = _txLatency ? _txLatency->sent(id, realtimeNs()) : TX_UNTRACKED;
+	int			ret = can_send_prebuilt(_prioritySocket, &frame);
+
+	if (ret >= 0)
+		TRACE_POINT(TRACE_CAN_WRITE, id);
+	else if (_txLatency)
+		_txLatency->failed(id, ticket);
+	return (ret);
+}
+
+// Own frames come back timestamped on the socket that sent them
+void	CANController::enableTxTimestamps(const uint16_t *ids, size_t count) {
+
+	if (!_initialized)
+		throw CANException("CAN not initialized");
+
+	if (can_enable_tx_echo(_socket, ids, count) < 0
+		|| can_enable_tx_echo(_prioritySocket, ids, count) < 0)
+		throw CANException("Failed to enable TX timestamps on: " + _interface);
+
+	if (!_txLatency) {
+		_echoBatch = std::make_unique<t_canRxBatch>();
+		can_rx_batch_init(_echoBatch.get());
+		_txLatency = std::make_unique<TxLatencyTracker>();
+	}
+	// Histograms of the echoed IDs exist before the first send
+	for (size_t i = 0; i < count; i++)
+		_txLatency->track(ids[i]);
+}
+
+int		CANController::collectTxConfirmations() noexcept {
+
+	if (!_txLatency)
+		return (-1);
+
+	const int	sockets[2] = {_socket, _prioritySocket};
+	t_canRxBatch	*batch = _echoBatch.get();
+	int			confirmed = 0;
+
+	// Tracepoints are CLOCK_MONOTONIC, socket timestamps CLOCK_REALTIME
+	[[maybe_unused]] int64_t	toMonotonic = traceNowNs() - realtimeNs();
+
+	for (int socket : sockets) {
+		int	count;
+		do {
+			count = can_receive_batch(socket, batch, 0, -1);
+			for (int i = 0; i < count; i++) {
+				// Same IDs sent by the other sockets (priority, CAN_BCM) arrive without MSG_CONFIRM
+				if (!(batch->msgs[i].msg_hdr.msg_flags & MSG_CONFIRM) || !batch->timestampsNs[i])
+					continue ;
+				uint16_t	id = static_cast<uint16_t>(batch->frames[i].can_id & CAN_SFF_MASK);
+				TRACE_POINT_AT(TRACE_TX_CONFIRM, id, batch->timestampsNs[i] + toMonotonic);
+				if (_txLatency->confirm(id, batch->timestampsNs[i]))
+					confirmed++;
+			}
+		} while (count == CAN_RX_BATCH_SIZE);
+	}
+	return (confirmed);
+}
+
+// Kernel-timed transmission, the period no longer depends on scheduling
+void	CANController::startCyclicFrame(const struct can_frame &frame,
+			std::chrono::microseconds period) {
+
+	if (!_initialized)
+		throw CANException("CAN not initialized");
+	if (_bcmSocket < 0)
+		throw CANException("CAN_BCM unavailable on: " + _interface);
+
+	if (period.count() <= 0 || period.count() > UINT32_MAX
+		|| can_bcm_tx_setup(_bcmSocket, &frame,
+			static_cast<uint32_t>(period.count())) < 0) {
+		throw CANException("Failed to start cyclic frame (ID: 0x" +
+		std::to_string(frame.can_id) + ")");
+	}
+}
+
+// Payload swap between two kernel transmissions, no throw
+int		CANController::updateCyclicFrame(const struct can_frame &frame,
+			bool sendNow) noexcept {
+
+	if (_bcmSocket < 0)
+		return (-1);
+
+	return (can_bcm_tx_update(_bcmSocket, &frame, sendNow));
+}
+
+void	CANController::stopCyclicFrame(uint16_t can_id) {
+
+	if (!_initialized)
+		throw CANException("CAN not initialized");
+	if (_bcmSocket < 0)
+		throw CANException("CAN_BCM unavailable on: " + _interface);
+
+	if (can_bcm_tx_delete(_bcmSocket, can_id) < 0) {
+		throw CANException("Failed to stop cyclic frame (ID: 0x" +
+		std::to_string(can_id) + ")");
+	}
+}
+
+// Kernel-side timeout, the caller only wakes up when the ID goes silent or resumes
+void	CANController::watchFrame(uint16_t can_id, std::chrono::microseconds timeout) {
+
+	if (!_initialized)
+		throw CANException("CAN not initialized");
+	if (_bcmSocket < 0)
+		throw CANException("CAN_BCM unavailable on: " + _interface);
+
+	if (timeout.count() <= 0 || timeout.count() > UINT32_MAX
+		|| can_bcm_rx_setup(_bcmSocket, can_id,
+			static_cast<uint32_t>(timeout.count())) < 0) {
+		throw CANException("Failed to watch frame (ID: 0x" +
+		std::to_string(can_id) + ")");
+	}
+}
+
+int		CANController::receiveWatchEvent(uint32_t *opcode, struct can_frame *frame,
+			int timeout_ms) {
+
+	if (!_initialized || _bcmSocket < 0)
+		return (-1);
+
+	return (can_bcm_receive(_bcmSocket, opcode, frame, timeout_ms, _wakeFd));
 }
 
 // TX handler sending frames in CAN_FD format
 void	CANController::sendFrameFD(uint16_t can_id, 
 			const int16_t* data, uint8_t len) {
 
-	std::lock_guard<std::mutex> lock(_mutex);
-
 	if (!_initialized)
 		throw CANException("CAN not initialized");
 
@@ -98,12 +332,38 @@ void	CANController::sendFrameFD(uint16_t can_id,
 // Reads incoming can messages present on the class socket
 int		CANController::receiveFrame(struct can_frame *frame) {
 
-	std::lock_guard<std::mutex> lock(_mutex);
-	return (can_try_receive(_socket, frame));
+	return (can_try_receive(_rxSocket, frame));
+}
+
+// Sleeps in the kernel until a frame arrives on the RX socket
+int		CANController::receiveFrameBlocking(struct can_frame *frame,
+			int timeout_ms) {
+
+	if (!_initialized)
+		return (-1);
+
+	return (can_receive_timeout(_rxSocket, frame, timeout_ms, _wakeFd));
+}
+
+// Drains all ready frames at once from the RX socket
+int		CANController::receiveBatch(t_canRxBatch *batch, int timeout_ms) {
+
+	if (!_initialized)
+		return (-1);
+
+	return (can_receive_batch(_rxSocket, batch, timeout_ms, _wakeFd));
+}
+
+// Latches the eventfd so blocked and future receives return immediately
+void	CANController::wakeup() {
+
+	uint64_t	one = 1;
+
+	if (_wakeFd >= 0 && write(_wakeFd, &one, sizeof(one)) < 0)
+		perror("write wakeup eventfd");
 }
 
 int		CANController::receiveFrameFD(struct canfd_frame *frame) {
 
-	std::lock_guard<std::mutex> lock(_mutex);
-	return (canfd_try_receive(_socket, frame));
+	return (canfd_try_receive(_rxSocket, frame));
 }
@@ -0,0 +1,40 @@
+#include "CANDispatcher.hpp"
+
+int		CANDispatcher::registerHandler(uint16_t can_id,
+			t_canHandler handler, void *ctx) {
+
+	if (can_id >= ID_COUNT || !handler) {
+		fprintf(stderr, "Invalid CAN handler registration (ID: 0x%X)\n", can_id);
+		return (-1);
+	}
+
+	if (_table[can_id].handler) {
+		fprintf(stderr, "CAN ID 0x%X already has a handler\n", can_id);
+		return (-1);
+	}
+
+	_table[can_id].handler = handler;
+	_table[can_id].ctx = ctx;
+	return (0);
+}
+
+void	CANDispatcher::unregisterHandler(uint16_t can_id) {
+
+	if (can_id < ID_COUNT)
+		_table[can_id] = Entry{};
+}
+
+// Walks the whole table once, only used at setup time
+size_t	CANDispatcher::subscribedIds(uint16_t *ids, size_t max) const {
+
+	size_t	count = 0;
+
+	for (size_t id = 0; id < ID_COUNT; id++) {
+		if (!_table[id].handler)
+			continue ;
+		if (count < max)
+			ids[count] = static_cast<uint16_t>(id);
+		count++;
+	}
+	return (count);
+}
@@ -0,0 +1,79 @@
+#include "DrivingCommandPublisher.hpp"
+#include "CANProtocol.hpp"
+
+#include <cstdlib>
+#include <ostream>
+#include <stdexcept>
+
+DrivingCommandPublisher::DrivingCommandPublisher(CANController *can,
+		const t_publisherConfig &config) : _can(can), _config(config) {
+
+	if (config.period.count() <= 0 || config.minGap.count() <= 0)
+		throw std::invalid_argument("Driving command period and gap must be positive");
+}
+
+e_publishAction	DrivingCommandPublisher::update(int16_t throttle, int16_t steering,
+					int64_t nowNs) {
+
+	_throttle = throttle;
+	_steering = steering;
+	_hasSetpoint = true;
+	_paused = false;
+
+	// Compared with what the MCU has, not with the previous setpoint, so slow drifts add up
+	if (!_hasSent
+		|| std::abs(throttle - _sentThrottle) >= _config.throttleStep
+		|| std::abs(steering - _sentSteering) >= _config.steeringStep)
+		_pending = true;
+
+	e_publishAction	action = publish(nowNs);
+	if (action == PUBLISH_NONE && _pending)
+		_stats.deferred++;
+	return (action);
+}
+
+e_publishAction	DrivingCommandPublisher::tick(int64_t nowNs) {
+
+	return (publish(nowNs));
+}
+
+e_publishAction	DrivingCommandPublisher::publish(int64_t nowNs) {
+
+	if (_paused || !_hasSetpoint)
+		return (PUBLISH_NONE);
+
+	int64_t	elapsed = nowNs - _lastSentNs;
+
+	if (_pending) {
+		if (_hasSent && elapsed < _config.minGap.count())
+			return (PUBLISH_NONE);
+		send(nowNs);
+		_stats.changes++;
+		return (PUBLISH_CHANGE);
+	}
+	if (elapsed >= _config.period.count()) {
+		send(nowNs);
+		_stats.refreshes++;
+		return (PUBLISH_REFRESH);
+	}
+	return (PUBLISH_NONE);
+}
+
+void	DrivingCommandPublisher::send(int64_t nowNs) {
+
+	_lastSentNs = nowNs;
+	_sentThrottle = _throttle;
+	_sentSteering = _steering;
+	_hasSent = true;
+	_pending = false;
+
+	if (_can)
+		CANProtocol::sendDrivingCommand(*_can, _throttle, _steering);
+}
+
+void	DrivingCommandPublisher::report(std::ostream &out, const char *prefix) const {
+
+	out << prefix << "driving command: changes " << _stats.changes
+		<< ", refreshes " << _stats.refreshes
+		<< ", deferred " << _stats.deferred << std::endl;
+}
@@ -0,0 +1,200 @@
+#include "TxLatencyTracker.hpp"
+
+#include <iomanip>
+#include <ostream>
+
+static_assert((TX_PENDING_PER_ID & (TX_PENDING_PER_ID - 1)) == 0,
+	"TX_PENDING_PER_ID must be a power of two");
+
+#define PENDING_MASK	(TX_PENDING_PER_ID - 1)
+
+// Existing entry of an ID, or the first free one claimed for it
+TxLatencyTracker::t_entry	*TxLatencyTracker::claim(uint16_t canId) noexcept {
+
+	for (t_entry &entry : _entries) {
+		int32_t	id = entry.id.load(std::memory_order_acquire);
+		if (id == canId)
+			return (&entry);
+		if (id == FREE) {
+			if (entry.id.compare_exchange_strong(id, canId, std::memory_order_acq_rel))
+				return (&entry);
+			if (id == canId)
+				return (&entry);
+		}
+	}
+	return (nullptr);
+}
+
+// Lookup only, never claims
+const TxLatencyTracker::t_entry	*TxLatencyTracker::find(uint16_t canId) const noexcept {
+
+	for (const t_entry &entry : _entries) {
+		int32_t	id = entry.id.load(std::memory_order_acquire);
+		if (id == canId)
+			return (&entry);
+		if (id == FREE)
+			break ;
+	}
+	return (nullptr);
+}
+
+TxLatencyTracker::t_entry	*TxLatencyTracker::find(uint16_t canId) noexcept {
+
+	return (const_cast<t_entry*>(static_cast<const TxLatencyTracker*>(this)->find(canId)));
+}
+
+uint64_t	TxLatencyTracker::sent(uint16_t canId, int64_t writeNs) noexcept {
+
+	t_entry	*entry = claim(canId);
+
+	if (!entry)
+		return (TX_UNTRACKED);
+
+	uint64_t	ticket = entry->sent.fetch_add(1, std::memory_order_acq_rel);
+	entry->writeNs[ticket & PENDING_MASK].store(writeNs, std::memory_order_release);
+	return (ticket);
+}
+
+void	TxLatencyTracker::failed(uint16_t canId, uint64_t ticket) noexcept {
+
+	if (ticket == TX_UNTRACKED)
+		return ;
+
+	t_entry	*entry = find(canId);
+	if (!entry)
+		return ;
+	entry->writeNs[ticket & PENDING_MASK].store(WRITE_FAILED, std::memory_order_release);
+	entry->failed.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool	TxLatencyTracker::confirm(uint16_t canId, int64_t echoNs) noexcept {
+
+	t_entry	*entry = find(canId);
+	int64_t	staleNs = std::chrono::nanoseconds(TX_ECHO_STALE).count();
+
+	if (!entry) {
+		_unmatched.fetch_add(1, std::memory_order_relaxed);
+		return (false);
+	}
+
+	uint64_t	sent = entry->sent.load(std::memory_order_acquire);
+
+	while (entry->next < sent) {
+		// More sends than slots went by unconfirmed, the oldest were overwritten
+		if (sent - entry->next > TX_PENDING_PER_ID) {
+			entry->lost.fetch_add(sent - TX_PENDING_PER_ID - entry->next,
+				std::memory_order_relaxed);
+			entry->next = sent - TX_PENDING_PER_ID;
+			continue ;
+		}
+
+		std::atomic<int64_t>	&slot = entry->writeNs[entry->next & PENDING_MASK];
+		int64_t					writeNs = slot.load(std::memory_order_acquire);
+
+		if (writeNs == WRITE_FAILED) {
+			slot.store(0, std::memory_order_relaxed);
+			entry->next++;
+			continue ;
+		}
+		// Not written yet, or the echo predates the send: not ours
+		if (writeNs == 0 || echoNs < writeNs)
+			break ;
+
+		// Its echo was lost if a newer send also went out well before this echo
+		if (echoNs - writeNs > staleNs && entry->next + 1 < sent) {
+			int64_t	newer = entry->writeNs[(entry->next + 1) & PENDING_MASK]
+				.load(std::memory_order_acquire);
+			if (newer > 0 && newer <= echoNs) {
+				slot.store(0, std::memory_order_relaxed);
+				entry->next++;
+				entry->lost.fetch_add(1, std::memory_order_relaxed);
+				continue ;
+			}
+		}
+
+		slot.store(0, std::memory_order_relaxed);
+		entry->next++;
+		record(*entry, echoNs - writeNs);
+		return (true);
+	}
+	_unmatched.fetch_add(1, std::memory_order_relaxed);
+	return (false);
+}
+
+// Single writer (confirm), the histogram is filled before confirmed is published
+void	TxLatencyTracker::record(t_entry &entry, int64_t latencyNs) noexcept {
+
+	entry.latency.record(latencyNs);
+	entry.confirmed.fetch_add(1, std::memory_order_release);
+}
+
+bool	TxLatencyTracker::track(uint16_t canId) noexcept {
+
+	return (claim(canId) != nullptr);
+}
+
+const LatencyHistogram	*TxLatencyTracker::histogram(uint16_t canId) const noexcept {
+
+	const t_entry	*entry = find(canId);
+
+	return (entry ? &entry->latency : nullptr);
+}
+
+bool	TxLatencyTracker::stats(uint16_t canId, t_txLatencyStats *stats) const noexcept {
+
+	const t_entry		*entry = find(canId);
+	t_histogramSummary	latency;
+
+	if (!entry)
+		return (false);
+
+	*stats = {};
+	stats->canId = canId;
+	stats->confirmed = entry->confirmed.load(std::memory_order_acquire);
+	stats->sent = entry->sent.load(std::memory_order_relaxed)
+		- entry->failed.load(std::memory_order_relaxed);
+	stats->lost = entry->lost.load(std::memory_order_relaxed);
+	if (stats->confirmed == 0)
+		return (true);
+
+	entry->latency.summarize(&latency);
+	stats->minNs = latency.minNs;
+	stats->maxNs = latency.maxNs;
+	stats->meanNs = latency.meanNs;
+	stats->p50Ns = latency.p50Ns;
+	stats->p99Ns = latency.p99Ns;
+	return (true);
+}
+
+size_t	TxLatencyTracker::ids(uint16_t *ids, size_t max) const noexcept {
+
+	size_t	count = 0;
+
+	for (const t_entry &entry : _entries) {
+		int32_t	id = entry.id.load(std::memory_order_acquire);
+		if (id == FREE || count == max)
+			break ;
+		ids[count++] = static_cast<uint16_t>(id);
+	}
+	return (count);
+}
+
+void	TxLatencyTracker::report(std::ostream &out, const char *prefix) const {
+
+	uint16_t			tracked[TX_TRACKED_IDS];
+	size_t				count = ids(tracked, TX_TRACKED_IDS);
+	t_txLatencyStats	s;
+
+	for (size_t i = 0; i < count; i++) {
+		if (!stats(tracked[i], &s))
+			continue ;
+		out << prefix << "0x" << std::hex << s.canId << std::dec
+			<< ": sent " << s.sent << ", confirmed " << s.confirmed
+			<< ", lost " << s.lost << std::fixed << std::setprecision(1)
+			<< ", min " << s.minNs / 1e3 << " us, mean " << s.meanNs / 1e3
+			<< " us, p50 " << s.p50Ns / 1e3 << " us, p99 " << s.p99Ns / 1e3
+			<< " us, max " << s.maxNs / 1e3 << " us" << std::endl;
+	}
+	if (unmatched())
+		out << prefix << unmatched() << " echoes without a matching send" << std::endl;
+}
@@ -1,56 +1,134 @@
 #include "carControl.h"
 
+// Upper bound on a blocking wait, so g_running is rechecked even without wakeup()
+#define RX_WAIT_TIMEOUT_MS	100
+
+// Speed sensor (handler hook declared in the generated CANMessages.hpp)
+void	CANMSG::SPEED::onFrame(const can_frame &rx, int64_t timestampNs, void *ctx) {
+
+	t_CANReceiver	*receiver = static_cast<t_CANReceiver*>(ctx);
+
+	if (rx.can_dlc < DLC)
+		return ;
+
+	t_speedData speedData = {};
+	speedData.rpm = unpack(rx.data).Rpm;
+	speedData.speedMps = rpmToSpeedMps(speedData.rpm);
+	speedData.timestampNs = timestampNs;
+
+	if (receiver->lastSpeedNs)
+		receiver->speedInterArrival.record(timestampNs - receiver->lastSpeedNs);
+	receiver->lastSpeedNs = timestampNs;
+
+	// Overwrites (and counts) the oldest sample if the consumer falls behind
+	if (receiver->queueSamples)
+		receiver->speedQueue.push(speedData);
+	receiver->speedMailbox.publish(speedData, timestampNs);
+}
+
+// Battery status
+void	CANMSG::BATTERY::onFrame(const can_frame &rx, int64_t timestampNs, void *ctx) {
+
+	t_CANReceiver	*receiver = static_cast<t_CANReceiver*>(ctx);
+
+	if (rx.can_dlc < DLC)
+		return ;
+
+	const Values	values = unpack(rx.data);
+	t_batteryData	batteryData = {};
+	batteryData.percentage = values.Percentage;
+	batteryData.voltage = values.Voltage;
+	batteryData.timestampNs = timestampNs;
+
+	if (receiver->lastBatteryNs)
+		receiver->batteryInterArrival.record(timestampNs - receiver->lastBatteryNs);
+	receiver->lastBatteryNs = timestampNs;
+
+	if (receiver->queueSamples)
+		receiver->batteryQueue.push(batteryData);
+	receiver->batteryMailbox.publish(batteryData, timestampNs);
+}
+
+// Every message received by RPI in dbc/vehicle.dbc needs an onFrame() above
+int	registerReceiverHandlers(t_CANReceiver* receiver) {
+
+	return (CANMSG::registerRxHandlers(receiver->dispatcher, receiver));
+}
+
+int		registerReceiverStats(t_CANReceiver* receiver) {
+
+	const TxLatencyTracker	*txLatency = receiver->can ? receiver->can->txLatency() : nullptr;
+	uint16_t				ids[TX_TRACKED_IDS];
+	size_t					count = txLatency ? txLatency->ids(ids, TX_TRACKED_IDS) : 0;
+	char					name[STATS_NAME_SIZE];
+	int						registered = 0;
+
+	registered += statsRegister("can.rx.speed.interarrival", &receiver->speedInterArrival) == 0;
+	registered += statsRegister("can.rx.battery.interarrival", &receiver->batteryInterArrival) == 0;
+	// Queues nobody pops would only publish empty histograms
+	if (receiver->queueSamples) {
+		registered += statsRegister("queue.speed.dwell", &receiver->speedDwell) == 0;
+		registered += statsRegister("queue.battery.dwell", &receiver->batteryDwell) == 0;
+	}
+	registered += statsRegister("mailbox.speed.age", &receiver->speedAge) == 0;
+	registered += statsRegister("mailbox.battery.age", &receiver->batteryAge) == 0;
+	for (size_t i = 0; i < count; i++) {
+		snprintf(name, sizeof(name), "can.tx.0x%03x", ids[i]);
+		registered += statsRegister(name, txLatency->histogram(ids[i])) == 0;
+	}
+	return (registered);
+}
+
+void	dispatchRxBatch(t_CANReceiver* receiver, const t_canRxBatch *batch, int count) {
+
+	struct timespec	realtime;
+	int64_t			nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	// Kernel timestamps are CLOCK_REALTIME, samples are compared with steady_clock
+	clock_gettime(CLOCK_REALTIME, &realtime);
+	int64_t	toSteady = nowNs - (static_cast<int64_t>(realtime.tv_sec) * 1000000000LL
+		+ realtime.tv_nsec);
+
+	for (int i = 0; i < count; i++) {
+		int64_t	timestampNs = nowNs;
+
+		// A wall clock step may not push a sample into the future
+		if (batch->timestampsNs[i] && batch->timestampsNs[i] + toSteady < nowNs)
+			timestampNs = batch->timestampsNs[i] + toSteady;
+
+		// The kernel filter should make this rare, a misbehaving node must not flood the log
+		if (!receiver->dispatcher.dispatch(batch->frames[i], timestampNs))
+			LOG_EVERY(std::chrono::seconds(1), LOG_OUT, "Unknown CAN ID: 0x{x}",
+				batch->frames[i].can_id);
+	}
+
+	receiver->rxDrops.store(batch->drops, std::memory_order_relaxed);
+}
+
 void	canReceiverThread(t_CANReceiver* receiver) {
 
-	can_frame	rx;
+	// Preallocated once, reused for every batch
+	t_canRxBatch	batch;
+	int				count;
+
+	can_rx_batch_init(&batch);
 
 	while (g_running.load()) {
 
-		memset(&rx, 0, sizeof(can_frame));
-		if (receiver->can->receiveFrame(&rx) == 0) {
-
-			auto now = std::chrono::steady_clock::now();
-
-			switch (rx.can_id) {
-
-				// Speed sensor
-				case CANRECEIVERID::SPEEDRPMSTM32: {
-					if (rx.can_dlc >= 2) {
-						t_speedData speedData;
-						speedData.rpm = (rx.data[0] << 8) | rx.data[1];
-
-						std::lock_guard<std::mutex> lock(receiver->speedMutex);
-						receiver->speedQueue.push(speedData);
-
-						// Limit the size to a max of only 10 entries
-						if (receiver->speedQueue.size() > 10)
-							receiver->speedQueue.pop();
-					}
-				}
-				break ;
-
-				// Battery status
-				case CANRECEIVERID::BATTERYSTM32: {
-					if (rx.can_dlc >= 3) {
-						t_batteryData	batteryData;
-						batteryData.percentage = (rx.data[0] << 8) | rx.data[1];
-						batteryData.voltage = rx.data[2];
-
-						std::lock_guard<std::mutex> lock(receiver->batteryMutex);
-						receiver->batteryQueue.push(batteryData);
-
-						if (receiver->batteryQueue.size() > 5)
-							receiver->batteryQueue.pop();
-					}
-				}
-				break ;
-
-					default:
-                    std::cout << "Unknown CAN ID: 0x" << std::hex 
-                              << rx.can_id << std::dec << std::endl;
-                    break ;
-			}
-        	std::this_thread::sleep_for(std::chrono::milliseconds(5));
-		}
+		count = receiver->can->receiveBatch(&batch, RX_WAIT_TIMEOUT_MS);
+
+		// Woken up through CANController::wakeup(), shutting down
+		if (count == CAN_RX_WAKEUP)
+			break ;
+
+		// TX echoes carry kernel timestamps, matching them late costs no accuracy
+		receiver->can->collectTxConfirmations();
+
+		// Timeout or error, nothing to dispatch
+		if (count <= 0)
+			continue ;
+
+		dispatchRxBatch(receiver, &batch, count);
 	}
 }
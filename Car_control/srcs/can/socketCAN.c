@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include "socketCAN.h"
 
 int	check_mtu_support(int s, struct ifreq *ifr) {
@@ -20,12 +21,13 @@ int	check_mtu_support(int s, struct ifreq *ifr) {
 	return (0);
 }
 
-int	socketCan_init(const char *interface) {
+// Creates a raw CAN socket bound to the interface, optionally checking its MTU
+static int	open_bound_socket(const char *interface, int check_mtu) {
 
 	struct sockaddr_can	addr;
 	struct ifreq		ifr;
 	int 				s;
-	int 				enable_canfd = 1;
+	int					enable = 1;
 
 	if (!interface)
 		return (-1);
@@ -42,7 +44,7 @@ int	socketCan_init(const char *interface) {
 	ifr.ifr_name[IFNAMSIZ - 1] = '\0';
 
 	// // Check MTU
-	if (check_mtu_support(s, &ifr) < 0) {
+	if (check_mtu && check_mtu_support(s, &ifr) < 0) {
 		close(s);
 		return (-1);
 	}
@@ -65,9 +67,205 @@ int	socketCan_init(const char *interface) {
 		close(s);
 		return (-1);
 	}
+
+	// Ask the kernel to report its receive queue drop counter (not fatal)
+	if (setsockopt(s, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) < 0)
+		perror("setsockopt SO_RXQ_OVFL");
+	return (s);
+}
+
+int	socketCan_init(const char *interface) {
+
+	return (open_bound_socket(interface, 1));
+}
+
+// Additional sockets on an interface already validated by socketCan_init
+int	socketCan_open(const char *interface) {
+
+	return (open_bound_socket(interface, 0));
+}
+
+// Broadcast manager message with a single frame, as used by TX_SETUP,
+// RX_SETUP and RX_CHANGED (RX_TIMEOUT only fills the head)
+typedef struct s_canBcmMsg {
+	struct bcm_msg_head	head;
+	struct can_frame	frame;
+} t_canBcmMsg;
+
+// Broadcast manager socket, the kernel runs the cyclic transmissions
+int	socketCan_bcm_open(const char *interface) {
+
+	struct sockaddr_can	addr;
+	int					s;
+	unsigned int		ifindex;
+
+	if (!interface)
+		return (-1);
+
+	ifindex = if_nametoindex(interface);
+	if (ifindex == 0) {
+		perror("if_nametoindex");
+		return (-1);
+	}
+
+	s = socket(PF_CAN, SOCK_DGRAM, CAN_BCM);
+	if (s < 0) {
+		perror("socket CAN_BCM");
+		return (-1);
+	}
+
+	// BCM sockets are connected, not bound
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = ifindex;
+	if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("connect CAN_BCM");
+		close(s);
+		return (-1);
+	}
 	return (s);
 }
 
+static int	bcm_write(int socket, t_canBcmMsg *msg, const char *what) {
+
+	if (write(socket, msg, sizeof(*msg)) < 0) {
+		perror(what);
+		return (-1);
+	}
+	return (0);
+}
+
+int	can_bcm_tx_setup(int socket, const struct can_frame *frame,
+		uint32_t period_us) {
+
+	t_canBcmMsg	msg;
+
+	if (!frame || period_us == 0)
+		return (-1);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.head.opcode			= TX_SETUP;
+	msg.head.can_id			= frame->can_id;
+	msg.head.flags			= SETTIMER | STARTTIMER | TX_ANNOUNCE;
+	msg.head.count			= 0;
+	msg.head.ival2.tv_sec	= period_us / 1000000;
+	msg.head.ival2.tv_usec	= period_us % 1000000;
+	msg.head.nframes		= 1;
+	msg.frame				= *frame;
+	return (bcm_write(socket, &msg, "write BCM TX_SETUP"));
+}
+
+// Content only update: no timer flag, so the running period is kept
+int	can_bcm_tx_update(int socket, const struct can_frame *frame, int send_now) {
+
+	t_canBcmMsg	msg;
+
+	if (!frame)
+		return (-1);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.head.opcode		= TX_SETUP;
+	msg.head.can_id		= frame->can_id;
+	msg.head.flags		= send_now ? TX_ANNOUNCE : 0;
+	msg.head.nframes	= 1;
+	msg.frame			= *frame;
+	return (bcm_write(socket, &msg, "write BCM TX_SETUP update"));
+}
+
+int	can_bcm_tx_delete(int socket, uint16_t can_id) {
+
+	t_canBcmMsg	msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.head.opcode	= TX_DELETE;
+	msg.head.can_id	= can_id;
+
+	// TX_DELETE carries no frame
+	if (write(socket, &msg.head, sizeof(msg.head)) < 0) {
+		perror("write BCM TX_DELETE");
+		return (-1);
+	}
+	return (0);
+}
+
+// Liveness watch: the zero mask hides content changes, only
+// first frame, timeout and resume are reported
+int	can_bcm_rx_setup(int socket, uint16_t can_id, uint32_t timeout_us) {
+
+	t_canBcmMsg	msg;
+
+	if (timeout_us == 0)
+		return (-1);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.head.opcode			= RX_SETUP;
+	msg.head.can_id			= can_id;
+	msg.head.flags			= SETTIMER | RX_ANNOUNCE_RESUME;
+	msg.head.ival1.tv_sec	= timeout_us / 1000000;
+	msg.head.ival1.tv_usec	= timeout_us % 1000000;
+	msg.head.nframes		= 1;
+	msg.frame.can_id		= can_id;
+	return (bcm_write(socket, &msg, "write BCM RX_SETUP"));
+}
+
+// Kernel-side reception filter: exact match on standard data frames only
+int	can_set_filters(int socket, const uint16_t *ids, size_t count) {
+
+	struct can_filter	filters[CAN_MAX_FILTERS];
+
+	if (count > CAN_MAX_FILTERS || (count > 0 && !ids)) {
+		fprintf(stderr, "Invalid CAN filter list (%zu entries)\n", count);
+		return (-1);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (ids[i] > CAN_SFF_MASK) {
+			fprintf(stderr, "Invalid CAN ID: 0x%X (too large)\n", ids[i]);
+			return (-1);
+		}
+		filters[i].can_id	= ids[i];
+		filters[i].can_mask	= CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+	}
+
+	if (setsockopt(socket, SOL_CAN_RAW, CAN_RAW_FILTER, count ? filters : NULL,
+			count * sizeof(struct can_filter)) < 0) {
+		perror("setsockopt CAN_RAW_FILTER");
+		return (-1);
+	}
+	return (0);
+}
+
+int	can_enable_rx_timestamps(int socket) {
+
+	int	enable = 1;
+
+	if (setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0) {
+		perror("setsockopt SO_TIMESTAMPNS");
+		return (-1);
+	}
+	return (0);
+}
+
+// Own frames come back to this socket with MSG_CONFIRM and a kernel timestamp
+int	can_enable_tx_echo(int socket, const uint16_t *ids, size_t count) {
+
+	int	enable = 1;
+	int	flags = CAN_TX_TIMESTAMPING;
+
+	if (can_set_filters(socket, ids, count) < 0)
+		return (-1);
+	if (setsockopt(socket, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS,
+			&enable, sizeof(enable)) < 0) {
+		perror("setsockopt CAN_RAW_RECV_OWN_MSGS");
+		return (-1);
+	}
+	if (setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0) {
+		perror("setsockopt SO_TIMESTAMPING");
+		return (-1);
+	}
+	return (0);
+}
+
 // Classical CAN Bus (8 bytes)
 int	can_send_frame(int socket, uint16_t can_id, 
 		const int8_t* data, uint8_t len) {
@@ -97,6 +295,24 @@ int	can_send_frame(int socket, uint16_t can_id,
 	return (0);
 }
 
+// Hot path for prebuilt frames, a single syscall and nothing else
+int	can_send_prebuilt(int socket, const struct can_frame *frame) {
+
+	if (write(socket, frame, sizeof(struct can_frame)) < 0)
+		return (-1);
+	return (0);
+}
+
+int	can_set_priority(int socket, int priority) {
+
+	if (setsockopt(socket, SOL_SOCKET, SO_PRIORITY,
+			&priority, sizeof(priority)) < 0) {
+		perror("setsockopt SO_PRIORITY");
+		return (-1);
+	}
+	return (0);
+}
+
 // CAN_FD (64 bytes)
 int	can_send_frame_fd(int socket, uint16_t can_id, 
 					  const int16_t *data, uint8_t len) {
@@ -145,6 +361,173 @@ int	can_try_receive(int socket, struct can_frame *frame)
 	return (0);
 }
 
+// Consumes and reports a pending socket error (e.g. ENETDOWN), then backs off
+// for the timeout so a persistent error cannot turn the caller into a busy loop
+// CAN_RX_WAKEUP returned if woken up during the back off, -1 otherwise
+static int	rx_error_backoff(int socket, int timeout_ms, int wake_fd) {
+
+	struct pollfd	pfd;
+	int				err = 0;
+	socklen_t		len = sizeof(err);
+
+	// Reading SO_ERROR also clears it
+	if (getsockopt(socket, SOL_SOCKET, SO_ERROR, &err, &len) < 0)
+		err = errno;
+	if (err)
+		fprintf(stderr, "CAN socket error: %s\n", strerror(err));
+	else
+		fprintf(stderr, "CAN socket hung up\n");
+
+	// A negative fd is ignored by poll(), which then simply sleeps
+	pfd.fd		= wake_fd;
+	pfd.events	= POLLIN;
+	pfd.revents	= 0;
+	if (poll(&pfd, 1, timeout_ms < 0 ? CAN_RX_ERROR_BACKOFF_MS : timeout_ms) > 0)
+		return (CAN_RX_WAKEUP);
+
+	errno = err ? err : EPIPE;
+	return (-1);
+}
+
+// Sleeps until the socket is readable, the timeout expires or wake_fd fires
+// 1 returned if readable, 0 on timeout, CAN_RX_WAKEUP if woken up, -1 on error
+static int	wait_readable(int socket, int timeout_ms, int wake_fd) {
+
+	struct pollfd	pfd[2];
+	nfds_t			nfds = 1;
+	int				ready;
+
+	pfd[0].fd		= socket;
+	pfd[0].events	= POLLIN;
+	pfd[0].revents	= 0;
+	if (wake_fd >= 0) {
+		pfd[1].fd		= wake_fd;
+		pfd[1].events	= POLLIN;
+		pfd[1].revents	= 0;
+		nfds = 2;
+	}
+
+	ready = poll(pfd, nfds, timeout_ms);
+	if (ready <= 0)
+		return (ready);
+
+	// Shutdown request has priority over pending frames
+	if (nfds == 2 && (pfd[1].revents & POLLIN))
+		return (CAN_RX_WAKEUP);
+
+	// Pending frames are still drained before an error is reported
+	if (pfd[0].revents & POLLIN)
+		return (1);
+	if (pfd[0].revents & (POLLERR | POLLHUP))
+		return (rx_error_backoff(socket, timeout_ms, wake_fd));
+	return (-1);
+}
+
+// Blocks until a frame arrives, the timeout expires or wake_fd is signaled
+// 0 returned if a frame was read, CAN_RX_TIMEOUT, CAN_RX_WAKEUP or -1 on error
+int	can_receive_timeout(int socket, struct can_frame *frame,
+		int timeout_ms, int wake_fd) {
+
+	int	ready = wait_readable(socket, timeout_ms, wake_fd);
+
+	if (ready == 0)
+		return (CAN_RX_TIMEOUT);
+	if (ready < 0)
+		return (ready);
+
+	if (read(socket, frame, sizeof(*frame)) < 0)
+		return (-1);
+
+	return (0);
+}
+
+void	can_rx_batch_init(t_canRxBatch *batch) {
+
+	memset(batch, 0, sizeof(*batch));
+	for (int i = 0; i < CAN_RX_BATCH_SIZE; i++) {
+		batch->iov[i].iov_base				= &batch->frames[i];
+		batch->iov[i].iov_len				= sizeof(struct can_frame);
+		batch->msgs[i].msg_hdr.msg_iov		= &batch->iov[i];
+		batch->msgs[i].msg_hdr.msg_iovlen	= 1;
+		batch->msgs[i].msg_hdr.msg_control	= batch->control[i];
+	}
+}
+
+static int64_t	timespec_ns(const struct timespec *ts) {
+
+	return ((int64_t)ts->tv_sec * 1000000000LL + ts->tv_nsec);
+}
+
+// Extracts the SO_RXQ_OVFL drop counter and the kernel timestamp of message i
+static void	parse_rx_cmsg(struct msghdr *msg, t_canRxBatch *batch, int i) {
+
+	struct cmsghdr	*cmsg;
+
+	batch->timestampsNs[i] = 0;
+	for (cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+		if (cmsg->cmsg_level != SOL_SOCKET)
+			continue ;
+		if (cmsg->cmsg_type == SO_RXQ_OVFL)
+			memcpy(&batch->drops, CMSG_DATA(cmsg), sizeof(uint32_t));
+		else if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+			struct scm_timestamping	ts;
+			memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+			batch->timestampsNs[i] = timespec_ns(&ts.ts[0]);
+		} else if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+			struct timespec	ts;
+			memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+			batch->timestampsNs[i] = timespec_ns(&ts);
+		}
+	}
+}
+
+// Waits like can_receive_timeout, then drains every ready frame at once
+int	can_receive_batch(int socket, t_canRxBatch *batch,
+		int timeout_ms, int wake_fd) {
+
+	int	count = wait_readable(socket, timeout_ms, wake_fd);
+
+	// Timeout, wakeup and error are passed through unchanged
+	if (count <= 0)
+		return (count);
+
+	// The kernel overwrites the control length, restore it before each call
+	for (int i = 0; i < CAN_RX_BATCH_SIZE; i++)
+		batch->msgs[i].msg_hdr.msg_controllen = sizeof(batch->control[i]);
+
+	count = recvmmsg(socket, batch->msgs, CAN_RX_BATCH_SIZE, MSG_DONTWAIT, NULL);
+	if (count < 0)
+		return (errno == EAGAIN ? 0 : -1);
+
+	for (int i = 0; i < count; i++)
+		parse_rx_cmsg(&batch->msgs[i].msg_hdr, batch, i);
+
+	return (count);
+}
+
+// Blocks until the broadcast manager reports an event on a watched ID
+int	can_bcm_receive(int socket, uint32_t *opcode, struct can_frame *frame,
+		int timeout_ms, int wake_fd) {
+
+	t_canBcmMsg	msg;
+	int			ready = wait_readable(socket, timeout_ms, wake_fd);
+
+	if (ready == 0)
+		return (CAN_RX_TIMEOUT);
+	if (ready < 0)
+		return (ready);
+
+	// RX_TIMEOUT carries no frame, clear it so callers never read stale data
+	memset(&msg, 0, sizeof(msg));
+	if (read(socket, &msg, sizeof(msg)) < (ssize_t)sizeof(msg.head))
+		return (-1);
+
+	*opcode = msg.head.opcode;
+	if (frame)
+		*frame = msg.frame;
+	return (0);
+}
+
 // Same as previous function but for can-fd
 int	canfd_try_receive(int socket, struct canfd_frame *frame) {
 
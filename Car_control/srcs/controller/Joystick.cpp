@@ -1,4 +1,8 @@
 #include "Joystick.hpp"
+#include "Trace.hpp"
+
+#include <cerrno>
+#include <poll.h>
 
 extern std::atomic<bool> g_running;
 
@@ -18,6 +22,17 @@ Joystick::Joystick() {
 		throw std::runtime_error(std::string("Error! Failed libevdev init..."));
 	}
 	ev = {};
+
+	// Event times on the tracepoint clock instead of CLOCK_REALTIME
+	libevdev_set_clock_id(dev, CLOCK_MONOTONIC);
+
+	// Axis limits don't change while the device is open
+	for (int code = 0; code <= ABS_MAX; ++code) {
+		const struct input_absinfo *ai = libevdev_has_event_code(dev, EV_ABS, code)
+			? libevdev_get_abs_info(dev, code) : nullptr;
+		if (ai)
+			_axes[code] = makeAxisScale(code, ai->minimum, ai->maximum);
+	}
 }
 
 Joystick::~Joystick() {
@@ -25,6 +40,51 @@ Joystick::~Joystick() {
 	close(fd);
 }
 
+t_axisScale	makeAxisScale(int axis_code, int32_t minimum, int32_t maximum) {
+
+	t_axisScale	scale = {};
+	int64_t		range = static_cast<int64_t>(maximum) - minimum;
+
+	if (range <= 0 || range > AXIS_MAX_RANGE)
+		return (scale);
+
+	uint64_t	span = (axis_code == ABS_Z) ? 180 : 200;
+
+	scale.present = true;
+	scale.range = static_cast<uint32_t>(range);
+	scale.factor = ((span << AXIS_SCALE_SHIFT) + scale.range - 1) / scale.range;
+	if (axis_code == ABS_Z) { // Steering
+		scale.inverted = false;
+		scale.origin = minimum;
+		scale.low = 0;
+		scale.high = 180;
+	} else {
+		scale.inverted = true;
+		scale.origin = (maximum + minimum) / 2;
+		scale.low = -100;
+		scale.high = 100;
+	}
+	return (scale);
+}
+
+// Sign-magnitude multiply-shift, truncates toward zero like the integer division it replaces
+int16_t	scaleAxis(const t_axisScale &scale, int32_t value) {
+
+	int64_t		delta = scale.inverted
+		? static_cast<int64_t>(scale.origin) - value
+		: static_cast<int64_t>(value) - scale.origin;
+	uint64_t	magnitude = static_cast<uint64_t>(delta < 0 ? -delta : delta);
+
+	// Out of range values clamp anyway, this keeps the product within 64 bits
+	if (magnitude > scale.range)
+		magnitude = scale.range + 1;
+
+	int64_t		normalized = static_cast<int64_t>((magnitude * scale.factor) >> AXIS_SCALE_SHIFT);
+	if (delta < 0)
+		normalized = -normalized;
+	return (static_cast<int16_t>(std::clamp<int64_t>(normalized, scale.low, scale.high)));
+}
+
 /**
  * @brief Normalizes axis to appropriate range based on axis code.
  *
@@ -35,23 +95,10 @@ Joystick::~Joystick() {
  */
 int16_t	Joystick::getAbs(int axis_code) const {
 
-	for (int code = 0; code <= ABS_MAX; ++code) {
-		if (libevdev_has_event_code(dev, EV_ABS, code) && code == axis_code) {
-			const struct input_absinfo *ai = libevdev_get_abs_info(dev, code);
-			if (ai) {
-				int range = ai->maximum - ai->minimum;
-				if (axis_code == ABS_Z) { // Steering
-					int normalized = ((ai->value - ai->minimum) * 180) / range;
-					return static_cast<int16_t>(std::clamp(normalized, 0, 180));
-				} else {
-					int center = (ai->maximum + ai->minimum) / 2;
-					int normalized = ((center - ai->value) * 200) / range;
-					return static_cast<int16_t>(std::clamp(normalized, -100, 100));
-				}
-			}
-		}
-	}
-	return (-1);
+	if (axis_code < 0 || axis_code > ABS_MAX || !_axes[axis_code].present)
+		return (-1);
+	return (scaleAxis(_axes[axis_code],
+		libevdev_get_event_value(dev, EV_ABS, static_cast<unsigned int>(axis_code))));
 }
 
 // Reads joystick buttons events pressed
@@ -68,10 +115,104 @@ int	Joystick::readPress(void) {
 			ev = current_ev; // Update last event
 			return (ev.code - 304);
 		}
+	} else if (rc == LIBEVDEV_READ_STATUS_SYNC) {
+		// Kernel buffer overflowed (SYN_DROPPED): replay the delta so getAbs() is current again
+		while (rc == LIBEVDEV_READ_STATUS_SYNC)
+			rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_SYNC, &current_ev);
+	} else if (rc == -ENODEV) {
+		return (-2);
 	}
 	return (-1);
 }
 
+// Button edges only, releases and autorepeat are not reported
+static uint32_t	pressBit(const struct input_event &e) {
+
+	if (e.type != EV_KEY || e.value != 1 || e.code < BTN_SOUTH || e.code >= BTN_SOUTH + 32)
+		return (0);
+	return (1u << (e.code - BTN_SOUTH));
+}
+
+// Drains events up to SYN_REPORT into one snapshot
+int	Joystick::readReport(t_joystickReport *report) {
+
+	struct input_event	current_ev;
+
+	while (true) {
+		rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &current_ev);
+
+		if (rc == LIBEVDEV_READ_STATUS_SYNC) {
+			// SYN_DROPPED: the delta replay brings libevdev back to the device state
+			while (rc == LIBEVDEV_READ_STATUS_SYNC) {
+				rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_SYNC, &current_ev);
+				if (rc == LIBEVDEV_READ_STATUS_SYNC)
+					_pressed |= pressBit(current_ev);
+			}
+			report->resynced = true;
+			break ;
+		}
+		if (rc == -ENODEV)
+			return (-1);
+		if (rc != LIBEVDEV_READ_STATUS_SUCCESS)
+			return (0);
+
+		if (current_ev.type == EV_SYN) {
+			if (current_ev.code != SYN_REPORT)
+				continue ;
+			report->resynced = false;
+			TRACE_BEGIN();
+			TRACE_POINT_AT(TRACE_EVDEV_EVENT, 0,
+				current_ev.input_event_sec * 1000000000LL + current_ev.input_event_usec * 1000LL);
+			break ;
+		}
+
+		// Same disconnect pattern as readPress()
+		if (ev.code == 0 && current_ev.code == 2
+			&& ev.value == 127 && current_ev.value == 127)
+			return (-1);
+		if (current_ev.value != 0)
+			ev = current_ev;
+		_pressed |= pressBit(current_ev);
+	}
+
+	report->steering = getAbs(ABS_Z);
+	report->throttle = getAbs(ABS_Y);
+	report->pressed = _pressed;
+	_pressed = 0;
+	TRACE_POINT(TRACE_DECODE, 0);
+	return (1);
+}
+
+// Checks the libevdev queue first, then sleeps on the device
+int	Joystick::waitEvent(int timeout_ms) const {
+
+	struct pollfd	pfd;
+	int				ret;
+
+	if (libevdev_has_event_pending(dev) > 0)
+		return (1);
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	do {
+		ret = poll(&pfd, 1, timeout_ms);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret < 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)))
+		return (-1);
+	return (ret > 0 ? 1 : 0);
+}
+
+bool	Joystick::hasPendingEvent(void) const {
+
+	return (waitEvent(0) == 1);
+}
+
+int	Joystick::getFd(void) const {
+
+	return (fd);
+}
+
 // Find if device is connected and what's the name
 void	Joystick::findJoystickDevice() {
 
@@ -0,0 +1,211 @@
+#include "CyclicExecutive.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+static int64_t	monotonicNs() {
+
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec);
+}
+
+CyclicExecutive::CyclicExecutive() {
+
+	_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (_timerFd < 0)
+		throw std::runtime_error("Failed to create executive timerfd");
+
+	_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_stopFd < 0) {
+		close(_timerFd);
+		throw std::runtime_error("Failed to create executive eventfd");
+	}
+}
+
+CyclicExecutive::~CyclicExecutive() {
+
+	close(_timerFd);
+	close(_stopFd);
+}
+
+int		CyclicExecutive::addTask(const char *name, t_cyclicTask task, void *ctx,
+			std::chrono::nanoseconds period, std::chrono::nanoseconds phase) {
+
+	if (!task || period.count() <= 0 || phase.count() < 0 || _count >= MAX_TASKS) {
+		fprintf(stderr, "Invalid cyclic task registration (%s)\n", name ? name : "?");
+		return (-1);
+	}
+
+	Task	&entry = _tasks[_count];
+	entry = Task{};
+	entry.name = name ? name : "task";
+	entry.task = task;
+	entry.ctx = ctx;
+	entry.periodNs = period.count();
+	entry.phaseNs = phase.count();
+	_jitter[_count].reset();
+	return (static_cast<int>(_count++));
+}
+
+int		CyclicExecutive::addInput(const char *name, int fd, t_cyclicTask task, void *ctx) {
+
+	if (!task || fd < 0 || _inputCount >= MAX_INPUTS) {
+		fprintf(stderr, "Invalid cyclic input registration (%s)\n", name ? name : "?");
+		return (-1);
+	}
+
+	Input	&entry = _inputs[_inputCount];
+	entry = Input{};
+	entry.name = name ? name : "input";
+	entry.fd = fd;
+	entry.task = task;
+	entry.ctx = ctx;
+	return (static_cast<int>(_inputCount++));
+}
+
+// Absolute deadline, the timer never accumulates wakeup latency
+int		CyclicExecutive::armTimer(int64_t deadlineNs) {
+
+	struct itimerspec	spec = {};
+
+	spec.it_value.tv_sec = deadlineNs / 1000000000LL;
+	spec.it_value.tv_nsec = deadlineNs % 1000000000LL;
+	if (timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+		perror("timerfd_settime");
+		return (-1);
+	}
+	return (0);
+}
+
+// Runs one release and books its jitter, execution time and overruns
+void	CyclicExecutive::release(Task &task, int64_t nowNs) {
+
+	t_taskStats	&stats = task.stats;
+	int64_t		jitter = nowNs - task.nextReleaseNs;
+
+	task.task(task.ctx);
+
+	int64_t		end = monotonicNs();
+	int64_t		exec = end - nowNs;
+
+	_jitter[&task - _tasks].record(jitter);
+	stats.runs++;
+	stats.lastJitterNs = jitter;
+	stats.lastExecNs = exec;
+	stats.totalExecNs += exec;
+	if (jitter > stats.maxJitterNs)
+		stats.maxJitterNs = jitter;
+	if (exec > stats.wcetNs)
+		stats.wcetNs = exec;
+
+	// Skip releases that already passed instead of running them back to back
+	task.nextReleaseNs += task.periodNs;
+	if (end >= task.nextReleaseNs) {
+		int64_t	missed = (end - task.nextReleaseNs) / task.periodNs + 1;
+		stats.overruns += static_cast<uint64_t>(missed);
+		task.nextReleaseNs += missed * task.periodNs;
+	}
+}
+
+int		CyclicExecutive::run(const std::atomic<bool> &running) {
+
+	if (_count == 0)
+		return (-1);
+
+	int64_t	start = monotonicNs();
+	for (size_t i = 0; i < _count; i++)
+		_tasks[i].nextReleaseNs = start + _tasks[i].phaseNs;
+
+	struct pollfd	pfd[2 + MAX_INPUTS];
+	nfds_t			nfds = 2 + _inputCount;
+	pfd[0].fd = _timerFd;
+	pfd[0].events = POLLIN;
+	pfd[1].fd = _stopFd;
+	pfd[1].events = POLLIN;
+	for (size_t i = 0; i < _inputCount; i++) {
+		pfd[2 + i].fd = _inputs[i].fd;
+		pfd[2 + i].events = POLLIN;
+	}
+
+	while (running.load() && !_stopped.load()) {
+
+		int64_t	deadline = _tasks[0].nextReleaseNs;
+		for (size_t i = 1; i < _count; i++) {
+			if (_tasks[i].nextReleaseNs < deadline)
+				deadline = _tasks[i].nextReleaseNs;
+		}
+
+		if (deadline > monotonicNs()) {
+			if (armTimer(deadline) < 0)
+				return (-1);
+			if (poll(pfd, nfds, -1) < 0) {
+				if (errno == EINTR)
+					continue ;
+				perror("poll executive");
+				return (-1);
+			}
+			if (pfd[1].revents & POLLIN)
+				break ;
+
+			// Inputs first, they are what the periodic tasks will act on
+			for (size_t i = 0; i < _inputCount && !_stopped.load(); i++) {
+				short	revents = pfd[2 + i].revents;
+				if (!revents)
+					continue ;
+				_inputs[i].wakeups++;
+				_inputs[i].task(_inputs[i].ctx);
+				// A negative fd is ignored by poll(), a dead descriptor would spin
+				if (revents & (POLLERR | POLLHUP | POLLNVAL))
+					pfd[2 + i].fd = -1;
+			}
+
+			if (!(pfd[0].revents & POLLIN))
+				continue ;
+			uint64_t	expirations;
+			if (read(_timerFd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+				continue ;
+		}
+
+		// Every due task, in registration order
+		for (size_t i = 0; i < _count && !_stopped.load(); i++) {
+			int64_t	now = monotonicNs();
+			if (_tasks[i].nextReleaseNs <= now)
+				release(_tasks[i], now);
+		}
+	}
+	return (0);
+}
+
+void	CyclicExecutive::stop() {
+
+	uint64_t	one = 1;
+
+	_stopped.store(true);
+	if (write(_stopFd, &one, sizeof(one)) < 0)
+		perror("write executive eventfd");
+}
+
+void	CyclicExecutive::report(std::ostream &out, const char *prefix) const {
+
+	for (size_t i = 0; i < _count; i++) {
+		const t_taskStats	&s = _tasks[i].stats;
+		out << prefix << _tasks[i].name
+			<< ": period " << _tasks[i].periodNs / 1000 << "us"
+			<< ", runs " << s.runs
+			<< ", overruns " << s.overruns
+			<< ", max jitter " << s.maxJitterNs / 1000 << "us"
+			<< ", WCET " << s.wcetNs / 1000 << "us"
+			<< ", avg exec " << (s.runs ? s.totalExecNs / static_cast<int64_t>(s.runs) / 1000 : 0)
+			<< "us" << std::endl;
+	}
+	for (size_t i = 0; i < _inputCount; i++)
+		out << prefix << _inputs[i].name << ": input, wakeups " << _inputs[i].wakeups << std::endl;
+}
@@ -1,12 +1,39 @@
 #include "carControl.h"
 
+void	autonomousCycle(void *ctx) {
+
+	t_autonomousState	*state = static_cast<t_autonomousState*>(ctx);
+	const t_carControl	&carControl = *state->carControl;
+
+	if (carControl.exit) {
+		if (state->executive)
+			state->executive->stop();
+		return ;
+	}
+
+	// The kernel repeats the brake with an exact period once started,
+	// without CAN_BCM the frame is sent from here instead
+	if (!state->kernelTimed)
+		state->kernelTimed = CANProtocol::startCyclicBrake(*carControl.can, true,
+			CANProtocol::BRAKE_REPEAT_PERIOD);
+	if (!state->kernelTimed)
+		CANProtocol::sendEmergencyBrake(*carControl.can, true);
+	else if (!carControl.can->isInitialized())
+		throw CANController::CANException("CAN not initialized");
+	//std::cout << "Emergency break message sent!" << std::endl;
+}
+
 // Core loop to agregate ai and autonomous automotive architecture
 void	autonomousLoop(const t_carControl &carControl) {
 
-	while (g_running.load() && !carControl.exit) {
+	if (!g_running.load() || carControl.exit)
+		return ;
 
-		CANProtocol::sendEmergencyBrake(*carControl.can, true);
-		//std::cout << "Emergency break message sent!" << std::endl;
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
+	CyclicExecutive		executive;
+	t_autonomousState	state = {&carControl, &executive, false};
+
+	executive.addTask("brake", autonomousCycle, &state, CANProtocol::BRAKE_REPEAT_PERIOD);
+	StatsRegistration	brakeJitter("control.autonomous.brake", &executive.jitter(0));
+	executive.run(g_running);
+	executive.report(std::cout, "[AUTONOMOUS] ");
 }
@@ -1,39 +1,131 @@
 #include "carControl.h"
 
-// Core loop to agregate joystick outputs and send them via CAN to the MCU
-void	manualLoop(t_carControl *carControl) {
+// Brake hold after the A button, driving commands are ignored meanwhile
+static constexpr auto	BRAKE_HOLD = std::chrono::milliseconds(500);
 
-	int16_t last_steering	= 0;
-	int16_t last_throttle 	= 0;
+static int64_t	nowNs() {
 
-	while (g_running.load() && carControl->controller) {
+	return (std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
 
-		int		value 		= carControl->controller->readPress();
-		int16_t	steering	= carControl->controller->getAbs(ABS_Z);
-		int16_t	throttle	= carControl->controller->getAbs(ABS_Y);
+// New setpoint for the publisher, which decides if it goes out now
+static void	sendAxes(t_manualState *state, int16_t steering, int16_t throttle) {
 
-		// Joystick disconection error
-		if (value == -2) {
-			CANProtocol::sendEmergencyBrake(*carControl->can, true);
-			continue ;
-		}
+	// STM32 silent: the monitor braked, nothing may override the brake
+	state->stm32Held = g_stm32Lost.load();
+	if (state->stm32Held) {
+		state->publisher->pause();
+		return ;
+	}
+
+	stableValues(&steering, &throttle);
+
+	if (state->publisher->update(throttle, steering, nowNs()) == PUBLISH_CHANGE)
+		LOG_INFO("Throttle: {} | Steering: {}", throttle, steering);
+}
+
+// Nothing but the brake may be sent until the next setpoint
+static void	brake(t_manualState *state) {
+
+	state->publisher->pause();
+	CANProtocol::sendEmergencyBrake(*state->carControl->can, true);
+}
+
+t_publisherConfig	drivingPublisherConfig(const t_carControl &carControl) {
+
+	t_publisherConfig	config;
+
+	config.period = std::chrono::nanoseconds(std::chrono::seconds(1)) / carControl.driveRateHz;
+	config.minGap = std::min<std::chrono::nanoseconds>(DRIVE_MIN_GAP, config.period);
+	return (config);
+}
+
+void	manualPublish(void *ctx) {
+
+	t_manualState	*state = static_cast<t_manualState*>(ctx);
+
+	state->publisher->tick(nowNs());
+}
+
+// Handles every queued HID report, one driving command per report at most
+void	manualInput(void *ctx) {
 
-		if (value == START_BUTTON) {
-			std::cout << "Initiating graceful shutdown..." << std::endl;
+	t_manualState		*state = static_cast<t_manualState*>(ctx);
+	t_carControl		*carControl = state->carControl;
+	t_joystickReport	report;
+	int					ret;
+
+	// Drained even during a brake hold: START must still work and libevdev keeps the axes
+	while ((ret = carControl->controller->readReport(&report)) == 1) {
+
+		if (report.pressed & (1u << START_BUTTON)) {
+			LOG_INFO("Initiating graceful shutdown...");
+			state->publisher->pause();
 			g_running.store(false);
-		} else if (value == A_BUTTON) {
-			CANProtocol::sendEmergencyBrake(*carControl->can, true);
-			std::this_thread::sleep_for(std::chrono::milliseconds(500));
-			continue ;
+			if (state->executive)
+				state->executive->stop();
+			return ;
 		}
+		if (report.pressed & (1u << A_BUTTON)) {
+			brake(state);
+			state->holdCycles = BRAKE_HOLD / CONTROL_PERIOD;
+		}
+		if (state->holdCycles > 0)
+			continue ;
+
+		sendAxes(state, report.steering, report.throttle);
+	}
+
+	// Joystick disconection error
+	if (ret < 0)
+		brake(state);
+}
+
+// One control cycle: brake hold countdown, then any report left queued
+void	manualCycle(void *ctx) {
 
-		stableValues(&steering, &throttle);
+	t_manualState	*state = static_cast<t_manualState*>(ctx);
 
-		if (steering != last_steering || throttle != last_throttle) {
-			CANProtocol::sendDrivingCommand(*carControl->can, throttle, steering);
-			std::cout << "Throttle: " << throttle << " | Steering: " << steering << std::endl;
-			last_steering = steering;
-			last_throttle = throttle;
+	if (state->holdCycles > 0) {
+		// Hold over: the stick may have moved without a report left to send it
+		if (--state->holdCycles == 0) {
+			Joystick	*controller = state->carControl->controller.get();
+			sendAxes(state, controller->getAbs(ABS_Z), controller->getAbs(ABS_Y));
 		}
+		return ;
 	}
+	// Held while the STM32 is lost, then resent even if the stick stays still
+	if (g_stm32Lost.load() || state->stm32Held) {
+		Joystick	*controller = state->carControl->controller.get();
+		sendAxes(state, controller->getAbs(ABS_Z), controller->getAbs(ABS_Y));
+	}
+	manualInput(state);
+}
+
+// Core loop to agregate joystick outputs and send them via CAN to the MCU
+void	manualLoop(t_carControl *carControl) {
+
+	if (!g_running.load() || !carControl->controller)
+		return ;
+
+	CyclicExecutive			executive;
+	t_publisherConfig		config = drivingPublisherConfig(*carControl);
+	DrivingCommandPublisher	publisher(carControl->can.get(), config);
+	t_manualState			state = {carControl, &executive, &publisher, 0, false};
+
+	// Input wakes the loop right away, the period only paces the brake hold
+	executive.addTask("joystick", manualCycle, &state, CONTROL_PERIOD);
+	// Checked every minimum gap so a deferred change waits no longer than that
+	executive.addTask("driving", manualPublish, &state, config.minGap);
+	executive.addInput("joystick events", carControl->controller->getFd(),
+		manualInput, &state);
+
+	// Queried through the stats endpoint while the loop runs
+	StatsRegistration	joystickJitter("control.manual.joystick", &executive.jitter(0));
+	StatsRegistration	drivingJitter("control.manual.driving", &executive.jitter(1));
+
+	executive.run(g_running);
+	executive.report(std::cout, "[MANUAL] ");
+	publisher.report(std::cout, "[MANUAL] ");
 }
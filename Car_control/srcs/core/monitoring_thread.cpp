@@ -1,51 +1,155 @@
 #include "carControl.h"
 
-void monitoringThread(t_CANReceiver* receiver) {
+std::atomic<bool>	g_stm32Lost = false;
+
+// Newest speed sample and kernel drops since the previous report
+bool	monitorReport(t_monitorState *state) {
+
+	t_CANReceiver	*receiver = state->receiver;
+	t_speedSample	speedSample;
+	bool			received = getLatestSpeed(receiver, &speedSample,
+						&state->lastSpeedSequence);
+
+	if (received) {
+		// Age from the kernel receive time, RX thread scheduling included
+		int64_t	now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		LOG_INFO("[MONITORING] Speed: {} m/s (RPM: {}, {} us old)",
+			speedSample.value.speedMps, speedSample.value.rpm,
+			(now - speedSample.timestampNs) / 1000);
+	}
+
+	// Kernel drops mean the receiver thread can't keep up with the bus
+	uint32_t rxDrops = receiver->rxDrops.load(std::memory_order_relaxed);
+	if (rxDrops != state->lastRxDrops) {
+		LOG_ERROR("[MONITORING] CAN RX overflow: {} frames dropped by the kernel ({} total)",
+			rxDrops - state->lastRxDrops, rxDrops);
+		state->lastRxDrops = rxDrops;
+	}
+	return (received);
+}
+
+static void	stm32Seen(t_monitorState *state) {
+
+	if (!state->firstSpeedReceived) {
+		state->firstSpeedReceived = true;
+		state->stm32Alive = true;
+		LOG_INFO("[MONITORING] Connection stablished...");
+	} else if (!state->stm32Alive) {
+		state->stm32Alive = true;
+		// Heartbeat was never touched, only the driving commands were held
+		g_stm32Lost.store(false);
+		LOG_INFO("[MONITORING] STM32 Connection restored! Driving commands resumed");
+	}
+}
+
+static void	stm32Lost(t_monitorState *state, std::chrono::nanoseconds silence) {
+
+	if (!state->stm32Alive)
+		return ;
+
+	state->stm32Alive = false;
+	// Set before the brake so no driving command can follow it
+	g_stm32Lost.store(true);
+	LOG_ERROR("[MONITORING] STM32 connection lost! No speed data for: {}ms",
+		std::chrono::duration_cast<std::chrono::milliseconds>(silence).count());
+	CANProtocol::sendEmergencyBrake(*state->receiver->can, true);
+}
+
+// Kernel CAN_BCM notification on the speed ID
+void	monitorEvent(t_monitorState *state, uint32_t event) {
+
+	if (event == RX_CHANGED)
+		stm32Seen(state);
+	else if (event == RX_TIMEOUT) {
+		t_speedSample	last;
+		int64_t			now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		auto			silence = state->receiver->speedMailbox.load(last)
+			? std::chrono::nanoseconds(now - last.timestampNs)
+			: std::chrono::nanoseconds(STM32_TIMEOUT);
+		stm32Lost(state, silence);
+	}
+}
+
+// Fallback without CAN_BCM: compare the clock against the last speed sample
+void	monitorPoll(void *ctx) {
 
-	constexpr auto STM32_TIMEOUT = std::chrono::milliseconds(600);
+	t_monitorState	*state = static_cast<t_monitorState*>(ctx);
 
-	auto lastSpeedDataReceived	= std::chrono::steady_clock::now();
-	bool stm32Alive				= false;
-	bool firstSpeedReceived		= false;
+	try {
+		auto now = std::chrono::steady_clock::now();
+
+		// Check if received speed data (stm heartbeat), only the newest one matters
+		if (monitorReport(state)) {
+			state->lastSpeedDataReceived = now;
+			stm32Seen(state);
+		}
+
+		if (state->firstSpeedReceived) {
+			auto timeSinceLastSpeed = now - state->lastSpeedDataReceived;
+
+			if (timeSinceLastSpeed >= STM32_TIMEOUT)
+				stm32Lost(state, timeSinceLastSpeed);
+		}
+	} catch (const std::exception &e) {
+		LOG_EVERY(std::chrono::seconds(1), LOG_ERR, "[MONITORING] ERROR: {}", e.what());
+	}
+}
+
+// Kernel CAN_BCM watch on the speed ID, no wakeup per frame while healthy
+// Returns false if the watch failed and the caller must poll instead
+static bool	eventMonitor(t_monitorState *state) {
+
+	CANController	*can = state->receiver->can;
 
 	while (g_running.load()) {
 		try {
-			auto now = std::chrono::steady_clock::now();
-
-			// Check if received speed data (stm heartbeat)
-			t_speedData speedData;
-			if (getSpeedData(receiver, &speedData)) {
-    			lastSpeedDataReceived = now;
-    			std::cout << "[MONITORING] Speed: " 
-					<< speedData.speedMps << " m/s (RPM: " 
-					<< speedData.rpm << ")\n";
-
-				if (!firstSpeedReceived) {
-					firstSpeedReceived = true;
-					stm32Alive = true;
-					std::cout << "[MONITORING] Connection stablished...\n";
-				}
-			}
+			uint32_t	event = 0;
+			int			ret = can->receiveWatchEvent(&event, nullptr,
+							MONITOR_REPORT_PERIOD.count());
 
-			if (firstSpeedReceived) {
-				auto timeSinceLastSpeed = now - lastSpeedDataReceived;
-
-				if (timeSinceLastSpeed >= STM32_TIMEOUT) {
-					if (stm32Alive) {
-						stm32Alive = false;
-						std::cerr << "[MONITORING] STM32 connection lost! No speed data for: "
-						<< std::chrono::duration_cast<std::chrono::milliseconds>(timeSinceLastSpeed).count()
-						<< "ms" << std::endl;
-						CANProtocol::sendEmergencyBrake(*receiver->can, true);
-					}
-				} else if (!stm32Alive) {
-					stm32Alive = true;
-					std::cout << "[MONITORING] STM32 Connection restored!\n";
-				}
+			if (ret == CAN_RX_WAKEUP)
+				break ;
+			if (ret == -1) {
+				const char	*err = strerror(errno);
+				LOG_ERROR("[MONITORING] CAN_BCM watch failed: {}, polling instead", err);
+				return (false);
 			}
+			if (ret == 0)
+				monitorEvent(state, event);
+			monitorReport(state);
 		} catch (const std::exception &e) {
-			std::cerr << "[MONITORING] ERROR: " << e.what() << std::endl;
+			LOG_EVERY(std::chrono::seconds(1), LOG_ERR, "[MONITORING] ERROR: {}", e.what());
 		}
-		std::this_thread::sleep_for(std::chrono::milliseconds(10));
 	}
+	return (true);
+}
+
+bool	watchStm32(CANController *can) {
+
+	try {
+		can->watchFrame(CANRECEIVERID::SPEEDRPMSTM32, STM32_TIMEOUT);
+	} catch (const std::exception &e) {
+		std::cerr << "[MONITORING] " << e.what() << ", polling instead" << std::endl;
+		return (false);
+	}
+	return (true);
+}
+
+void monitoringThread(t_CANReceiver* receiver) {
+
+	t_monitorState	state;
+	state.receiver = receiver;
+
+	if (watchStm32(receiver->can) && eventMonitor(&state))
+		return ;
+
+	CyclicExecutive		executive;
+
+	state.lastSpeedDataReceived = std::chrono::steady_clock::now();
+	executive.addTask("monitor", monitorPoll, &state, CONTROL_PERIOD);
+	StatsRegistration	pollJitter("control.monitor.poll", &executive.jitter(0));
+	executive.run(g_running);
+	executive.report(std::cout, "[MONITORING] ");
 }
@@ -0,0 +1,223 @@
+#include "carControl.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+
+// Tags stored in epoll_event.data, one per source
+enum e_reactorSource : uint32_t {
+	SRC_SIGNAL,
+	SRC_TIMER,
+	SRC_CAN_RX,
+	SRC_CAN_WATCH,
+	SRC_JOYSTICK
+};
+
+#define REACTOR_MAX_EVENTS	8
+
+typedef struct s_reactorStats {
+	uint64_t	ticks		= 0;
+	uint64_t	overruns	= 0;	/**< Timer expirations missed between two ticks */
+	uint64_t	rxBatches	= 0;
+	uint64_t	rxFrames	= 0;
+	uint64_t	watchEvents	= 0;
+	uint64_t	joyWakeups	= 0;
+} t_reactorStats;
+
+static int	addSource(int epollFd, int fd, uint32_t tag, uint32_t events) {
+
+	struct epoll_event	ev = {};
+
+	ev.events = events;
+	ev.data.u32 = tag;
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		perror("epoll_ctl reactor");
+		return (-1);
+	}
+	return (0);
+}
+
+// Periodic descriptor on CONTROL_PERIOD, replaces the CyclicExecutive of each thread
+static int	openControlTimer() {
+
+	auto				periodNs = std::chrono::nanoseconds(CONTROL_PERIOD).count();
+	struct itimerspec	spec = {};
+	int					fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+	if (fd < 0) {
+		perror("timerfd_create reactor");
+		return (-1);
+	}
+	spec.it_interval.tv_sec = periodNs / 1000000000LL;
+	spec.it_interval.tv_nsec = periodNs % 1000000000LL;
+	spec.it_value = spec.it_interval;
+	if (timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+		perror("timerfd_settime reactor");
+		close(fd);
+		return (-1);
+	}
+	return (fd);
+}
+
+static void	closeFd(int fd) {
+
+	if (fd >= 0)
+		close(fd);
+}
+
+int	reactorLoop(t_carControl *carControl, t_CANReceiver *receiver) {
+
+	CANController		*can = carControl->can.get();
+	t_reactorStats		stats;
+	t_canRxBatch		batch;
+	t_monitorState		monitor;
+	DrivingCommandPublisher	publisher(can, drivingPublisherConfig(*carControl));
+	t_manualState		manual = {carControl, nullptr, &publisher, 0, false};
+	t_autonomousState	autonomous = {carControl, nullptr, false};
+	sigset_t			signals;
+	sigset_t			previous;
+	int					ret = 0;
+
+	if (carControl->manual && !carControl->controller)
+		return (-1);
+
+	// Signals become readable events instead of interrupting the loop
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, &previous);
+
+	int	signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+	int	timerFd = openControlTimer();
+	int	epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+	monitor.receiver = receiver;
+	monitor.lastSpeedDataReceived = std::chrono::steady_clock::now();
+	bool	kernelWatch = watchStm32(can);
+
+	if (signalFd < 0 || timerFd < 0 || epollFd < 0
+		|| addSource(epollFd, signalFd, SRC_SIGNAL, EPOLLIN) < 0
+		|| addSource(epollFd, timerFd, SRC_TIMER, EPOLLIN) < 0
+		|| addSource(epollFd, can->getRxSocket(), SRC_CAN_RX, EPOLLIN) < 0
+		|| (kernelWatch
+			&& addSource(epollFd, can->getBcmSocket(), SRC_CAN_WATCH, EPOLLIN) < 0)
+		|| (carControl->manual
+			&& addSource(epollFd, carControl->controller->getFd(), SRC_JOYSTICK,
+				EPOLLIN) < 0))
+		ret = -1;
+
+	// Start delay of the control ticks, queried through the stats endpoint
+	const int64_t		periodNs = std::chrono::nanoseconds(CONTROL_PERIOD).count();
+	LatencyHistogram	tickJitter;
+	StatsRegistration	tickStats("control.reactor.tick", &tickJitter);
+
+	const uint64_t	brakeTicks = CANProtocol::BRAKE_REPEAT_PERIOD / CONTROL_PERIOD;
+	const uint64_t	reportTicks = MONITOR_REPORT_PERIOD / CONTROL_PERIOD;
+	struct epoll_event	events[REACTOR_MAX_EVENTS];
+
+	can_rx_batch_init(&batch);
+
+	try {
+		while (ret == 0 && g_running.load() && !carControl->exit) {
+
+			int	n = epoll_wait(epollFd, events, REACTOR_MAX_EVENTS, -1);
+			if (n < 0) {
+				if (errno == EINTR)
+					continue ;
+				perror("epoll_wait reactor");
+				ret = -1;
+				break ;
+			}
+
+			for (int i = 0; i < n && g_running.load(); i++) {
+				switch (events[i].data.u32) {
+
+				case SRC_SIGNAL: {
+					struct signalfd_siginfo	info;
+					if (read(signalFd, &info, sizeof(info)) == sizeof(info))
+						g_running.store(false);
+					break ;
+				}
+
+				case SRC_CAN_RX: {
+					int	count = can->receiveBatch(&batch, 0);
+					if (count > 0) {
+						dispatchRxBatch(receiver, &batch, count);
+						stats.rxBatches++;
+						stats.rxFrames += static_cast<uint64_t>(count);
+					}
+					break ;
+				}
+
+				case SRC_CAN_WATCH: {
+					uint32_t	event = 0;
+					if (can->receiveWatchEvent(&event, nullptr, 0) == 0) {
+						monitorEvent(&monitor, event);
+						stats.watchEvents++;
+					}
+					break ;
+				}
+
+				case SRC_JOYSTICK:
+					stats.joyWakeups++;
+					manualInput(&manual);
+					// A removed device stays ready forever, manualInput() already braked
+					if (events[i].events & (EPOLLERR | EPOLLHUP))
+						epoll_ctl(epollFd, EPOLL_CTL_DEL, carControl->controller->getFd(), nullptr);
+					break ;
+
+				case SRC_TIMER: {
+					uint64_t	expirations = 0;
+					if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations))
+						break ;
+
+					// Missed ticks are skipped, not replayed back to back
+					stats.overruns += expirations - 1;
+					stats.ticks++;
+
+					// Time since the last expiration is what is left of the period
+					struct itimerspec	left;
+					if (timerfd_gettime(timerFd, &left) == 0)
+						tickJitter.record(periodNs - (left.it_value.tv_sec * 1000000000LL
+							+ left.it_value.tv_nsec));
+
+					// The timer is the publisher clock here, gaps round up to CONTROL_PERIOD
+					if (carControl->manual) {
+						manualCycle(&manual);
+						manualPublish(&manual);
+					}
+					else if ((stats.ticks - 1) % brakeTicks == 0)
+						autonomousCycle(&autonomous);
+
+					can->collectTxConfirmations();
+
+					if (!kernelWatch)
+						monitorPoll(&monitor);
+					else if (stats.ticks % reportTicks == 0)
+						monitorReport(&monitor);
+					break ;
+				}
+				}
+			}
+		}
+	} catch (const std::exception &e) {
+		std::cerr << "[REACTOR] " << e.what() << std::endl;
+	}
+
+	closeFd(epollFd);
+	closeFd(timerFd);
+	closeFd(signalFd);
+	pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+
+	std::cout << "[REACTOR] ticks " << stats.ticks
+		<< ", overruns " << stats.overruns
+		<< ", CAN batches " << stats.rxBatches
+		<< " (" << stats.rxFrames << " frames)"
+		<< ", watch events " << stats.watchEvents
+		<< ", joystick wakeups " << stats.joyWakeups << std::endl;
+	if (carControl->manual)
+		publisher.report(std::cout, "[REACTOR] ");
+	return (ret);
+}
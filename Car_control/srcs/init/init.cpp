@@ -11,6 +11,13 @@ t_carControl	initCarControl(int argc, char *argv[]) {
 	carControl.canInterface		= "can0";
 	carControl.manual			= true;
 	carControl.exit				= false;
+	carControl.reactor			= false;
+	carControl.driveRateHz		= DRIVE_RATE_HZ;
+	carControl.txTimestamps		= false;
+	carControl.statsSocket		= STATS_SOCKET_PATH;
+	carControl.rt.control		= {RT_CONTROL_CPU, RT_CONTROL_PRIO};
+	carControl.rt.rx			= {RT_RX_CPU, RT_RX_PRIO};
+	carControl.rt.monitor		= {RT_MONITOR_CPU, RT_MONITOR_PRIO};
 
 	// Overriding default values using user input
 	if (parsingArgv(argc, argv, &carControl) <= 0)
@@ -19,6 +26,8 @@ t_carControl	initCarControl(int argc, char *argv[]) {
 	// CAN_fd init
 	try {
 		carControl.can = init_can(carControl.canInterface);
+		if (carControl.txTimestamps)
+			carControl.can->enableTxTimestamps(CANMSG::TX_IDS, CANMSG::TX_COUNT);
 	} catch (const CANController::CANException& e) {
 		std::cerr << e.what() << std::endl;
 		carControl.exit = true;
@@ -40,3 +49,29 @@ t_carControl	initCarControl(int argc, char *argv[]) {
 	}
 	return (carControl);
 }
+
+// Registers the receive handlers and subscribes the RX socket to exactly their IDs
+int	initCANReceiver(t_CANReceiver* receiver, CANController* can) {
+
+	uint16_t	ids[CAN_MAX_FILTERS];
+	size_t		count;
+
+	receiver->can = can;
+	if (registerReceiverHandlers(receiver) < 0)
+		return (0);
+
+	count = receiver->dispatcher.subscribedIds(ids, CAN_MAX_FILTERS);
+	if (count > CAN_MAX_FILTERS) {
+		std::cerr << "Too many CAN receive IDs for the kernel filter: "
+				  << count << std::endl;
+		return (0);
+	}
+
+	try {
+		can->setReceiveFilter(ids, count);
+	} catch (const CANController::CANException& e) {
+		std::cerr << e.what() << std::endl;
+		return (0);
+	}
+	return (1);
+}
@@ -0,0 +1,71 @@
+#include "carControl.h"
+#include <cstring>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+// Touches the stack once so the first deep call can't page fault
+static void	prefaultStack() {
+
+	volatile unsigned char	stack[RT_STACK_PREFAULT];
+
+	for (size_t i = 0; i < sizeof(stack); i += 4096)
+		stack[i] = 0;
+}
+
+int	applyProcessProfile(const t_rtProfile &profile) {
+
+	if (!profile.enabled)
+		return (0);
+
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+		std::cerr << "[RT] mlockall failed (" << strerror(errno)
+				  << "), memory stays pageable" << std::endl;
+		return (0);
+	}
+	prefaultStack();
+	std::cout << "[RT] Memory locked (mlockall current and future)" << std::endl;
+	return (1);
+}
+
+int	applyThreadProfile(const char *name, const t_threadProfile &profile) {
+
+	std::ostringstream	log;
+	int					applied = 1;
+	int					err;
+
+	log << "[RT] " << name << ":";
+
+	if (profile.cpu >= 0) {
+		cpu_set_t	set;
+		CPU_ZERO(&set);
+		CPU_SET(profile.cpu, &set);
+		err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		if (err) {
+			log << " cpu " << profile.cpu << " refused (" << strerror(err) << ")";
+			applied = 0;
+		} else
+			log << " cpu " << profile.cpu;
+	} else
+		log << " unpinned";
+
+	if (profile.priority > 0) {
+		struct sched_param	param = {};
+		param.sched_priority = profile.priority;
+		err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (err) {
+			log << ", SCHED_FIFO " << profile.priority << " refused ("
+				<< strerror(err) << "), SCHED_OTHER";
+			applied = 0;
+		} else
+			log << ", SCHED_FIFO " << profile.priority;
+	} else
+		log << ", SCHED_OTHER";
+
+	prefaultStack();
+	log << ", " << RT_STACK_PREFAULT / 1024 << "KiB stack prefaulted";
+
+	(applied ? std::cout : std::cerr) << log.str() << std::endl;
+	return (applied);
+}
@@ -1,20 +1,99 @@
 #include "carControl.h"
+#include "Trace.hpp"
+
+// Last echoes, then the latency of every ID sent (--tx-timestamps)
+static void	reportTxLatency(const t_carControl &carControl) {
+
+	const TxLatencyTracker	*txLatency = carControl.can->txLatency();
+
+	if (!txLatency)
+		return ;
+	carControl.can->collectTxConfirmations();
+	txLatency->report(std::cout, "[CAN TX] ");
+}
+
+// Writes the tracepoints once every recording thread is done
+static void	dumpTrace(const t_carControl &carControl) {
+
+	if (carControl.tracePath.empty())
+		return ;
+#ifndef ENABLE_TRACEPOINTS
+	std::cerr << "--trace ignored, built without ENABLE_TRACEPOINTS" << std::endl;
+#else
+	long	written = traceDump(carControl.tracePath.c_str());
+	if (written >= 0)
+		std::cout << "[TRACE] " << written << " records written to "
+				  << carControl.tracePath << std::endl;
+#endif
+}
 
 int	main(int argc, char *argv[]) {
 
 	signalManager();
 
+	// Background writer of the LOG_* records, flushed when main returns
+	LogSession	logSession;
+
 	t_carControl carControl = initCarControl(argc, argv);
 	if (carControl.exit)
 		return (1);
 
 	// Initialize CAN receiver
     t_CANReceiver canReceiver;
-    canReceiver.can = carControl.can.get();
+	if (!initCANReceiver(&canReceiver, carControl.can.get()))
+		return (1);
+
+	// Latency histograms readable with tools/carstats while the car runs
+	StatsSession	statsSession(carControl.statsSocket);
+	registerReceiverStats(&canReceiver);
+
+	// Kernel-timed heartbeat, stops by itself if this process dies
+	try {
+		if (!CANProtocol::startCyclicBrake(*carControl.can, false,
+				CANProtocol::HEARTBEAT_PERIOD))
+			std::cerr << "Heartbeat disabled, CAN_BCM unavailable" << std::endl;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+	}
+
+	// Locks memory before the threads start so their stacks are locked too
+	const t_rtProfile	&rt = carControl.rt;
+	if (rt.enabled)
+		applyProcessProfile(rt);
+
+	// Everything on this thread, no RX or monitor thread to start
+	if (carControl.reactor) {
+		if (rt.enabled)
+			applyThreadProfile("control", rt.control);
+		std::cout << "Reactor mode, " << (carControl.manual ? "manual" : "autonomous")
+				  << " control on a single thread..." << std::endl;
+		int	ret = reactorLoop(&carControl, &canReceiver);
+		g_running.store(false);
+		try {
+			CANProtocol::sendEmergencyBrake(*carControl.can, true);
+		} catch (...) {
+			dumpTrace(carControl);
+			return (1);
+		}
+		reportTxLatency(carControl);
+		dumpTrace(carControl);
+		return (ret < 0 ? 1 : 0);
+	}
 
 	// Threads launcher
-    std::thread rxThread(canReceiverThread, &canReceiver);
-    std::thread monitorThread(monitoringThread, &canReceiver);
+    std::thread rxThread([&canReceiver, &rt]() {
+		if (rt.enabled)
+			applyThreadProfile("rx", rt.rx);
+		canReceiverThread(&canReceiver);
+	});
+    std::thread monitorThread([&canReceiver, &rt]() {
+		if (rt.enabled)
+			applyThreadProfile("monitor", rt.monitor);
+		monitoringThread(&canReceiver);
+	});
+
+	if (rt.enabled)
+		applyThreadProfile("control", rt.control);
 
 	try {
 		if (!carControl.manual) {
@@ -28,16 +107,23 @@ int	main(int argc, char *argv[]) {
 		std::cerr << e.what() << std::endl;
 	}
 
-    if (rxThread.joinable())
-        rxThread.join();
+	// Stop worker threads and release the receiver from its blocking wait
+	g_running.store(false);
+	carControl.can->wakeup();
+
+	if (rxThread.joinable())
+		rxThread.join();
 
-    if (monitorThread.joinable())
-        monitorThread.join();
+	if (monitorThread.joinable())
+		monitorThread.join();
 
 	try {
 		CANProtocol::sendEmergencyBrake(*carControl.can, true);
 	} catch (...) {
+		dumpTrace(carControl);
 		return (1);
 	}
+	reportTxLatency(carControl);
+	dumpTrace(carControl);
 	return (0);
 }
@@ -0,0 +1,231 @@
+#include "AsyncLogger.hpp"
+#include "SPSCRingBuffer.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <system_error>
+#include <thread>
+
+enum e_ringState : int {
+	RING_FREE,
+	RING_OWNED,		/**< A live thread produces into it */
+	RING_RETIRED	/**< Producer exited, freed once drained */
+};
+
+typedef struct s_logRing {
+	std::atomic<int>							state{RING_FREE};
+	SPSCRingBuffer<t_logRecord, LOG_RING_SIZE>	records;
+} t_logRing;
+
+// Preallocated, a thread only claims one of them
+static t_logRing				g_rings[LOG_MAX_THREADS];
+static std::atomic<uint64_t>	g_unringed{0};	// Records of threads that found no free ring
+
+static std::thread				g_writer;
+static std::atomic<bool>		g_writerRunning{false};
+static int						g_fds[2] = {STDOUT_FILENO, STDERR_FILENO};
+static uint64_t					g_reportedDrops = 0;
+
+// Claimed on the first record of a thread, retired when the thread exits
+struct LogRingOwner {
+	t_logRing	*ring = nullptr;
+	bool		claimed = false;
+
+	~LogRingOwner() {
+		if (ring)
+			ring->state.store(RING_RETIRED, std::memory_order_release);
+	}
+};
+
+static thread_local LogRingOwner	t_owner;
+
+static t_logRing	*claimRing() {
+
+	for (t_logRing &ring : g_rings) {
+		int	state = RING_FREE;
+		if (ring.state.compare_exchange_strong(state, RING_OWNED))
+			return (&ring);
+		// A retired ring has no producer left, its records stay readable
+		state = RING_RETIRED;
+		if (ring.state.compare_exchange_strong(state, RING_OWNED))
+			return (&ring);
+	}
+	return (nullptr);
+}
+
+void	logSubmit(const t_logRecord &record) {
+
+	if (!t_owner.claimed) {
+		t_owner.claimed = true;
+		t_owner.ring = claimRing();
+	}
+	if (!t_owner.ring) {
+		g_unringed.fetch_add(1, std::memory_order_relaxed);
+		return ;
+	}
+	t_owner.ring->records.push(record);
+}
+
+uint64_t	logDropped() {
+
+	uint64_t	dropped = g_unringed.load(std::memory_order_relaxed);
+
+	for (const t_logRing &ring : g_rings)
+		dropped += ring.records.dropped();
+	return (dropped);
+}
+
+static size_t	append(char *out, size_t size, size_t len, const char *src, size_t n) {
+
+	if (len + 1 >= size)
+		return (len);
+	if (n > size - 1 - len)
+		n = size - 1 - len;
+	std::memcpy(out + len, src, n);
+	return (len + n);
+}
+
+static size_t	appendArg(char *out, size_t size, size_t len, const t_logRecord &record,
+					const t_logArg &arg, bool hex) {
+
+	char	buf[32];
+	int		n = 0;
+
+	switch (arg.type) {
+	case LOG_ARG_INT:
+		n = hex ? snprintf(buf, sizeof(buf), "%" PRIx64, static_cast<uint64_t>(arg.i))
+				: snprintf(buf, sizeof(buf), "%" PRId64, arg.i);
+		break ;
+	case LOG_ARG_UINT:
+		n = snprintf(buf, sizeof(buf), hex ? "%" PRIx64 : "%" PRIu64, arg.u);
+		break ;
+	case LOG_ARG_DOUBLE:
+		n = snprintf(buf, sizeof(buf), "%g", arg.d);
+		break ;
+	case LOG_ARG_TEXT: {
+		const char	*text = record.text + arg.text;
+		return (append(out, size, len, text, strnlen(text, LOG_TEXT_SIZE - arg.text)));
+	}
+	}
+	return (append(out, size, len, buf, n > 0 ? static_cast<size_t>(n) : 0));
+}
+
+size_t	logFormat(const t_logRecord &record, char *out, size_t size) {
+
+	const char	*format = record.site->format;
+	size_t		len = 0;
+	uint8_t		next = 0;
+
+	if (size == 0)
+		return (0);
+
+	while (*format) {
+		bool	plain = std::strncmp(format, "{}", 2) == 0;
+		bool	hex = std::strncmp(format, "{x}", 3) == 0;
+
+		if ((plain || hex) && next < record.argc) {
+			len = appendArg(out, size, len, record, record.args[next++], hex);
+			format += plain ? 2 : 3;
+		} else
+			len = append(out, size, len, format++, 1);
+	}
+
+	if (record.suppressed) {
+		char	buf[48];
+		int		n = snprintf(buf, sizeof(buf), " [+%u suppressed]", record.suppressed);
+		len = append(out, size, len, buf, n > 0 ? static_cast<size_t>(n) : 0);
+	}
+	out[len] = '\0';
+	return (len);
+}
+
+// One write per stream and pass, lines are never split across writes
+static void	flushBuffer(int stream, char *buf, size_t *len) {
+
+	size_t	done = 0;
+
+	while (done < *len) {
+		ssize_t	n = write(g_fds[stream], buf + done, *len - done);
+		if (n <= 0)
+			break ;
+		done += static_cast<size_t>(n);
+	}
+	*len = 0;
+}
+
+static void	drainRings() {
+
+	static char		buf[2][8192];
+	size_t			len[2] = {0, 0};
+	t_logRecord		record;
+	char			line[512];
+
+	for (t_logRing &ring : g_rings) {
+		int	state = ring.state.load(std::memory_order_acquire);
+		if (state == RING_FREE)
+			continue ;
+
+		while (ring.records.pop(record)) {
+			int		stream = record.site->stream == LOG_ERR ? 1 : 0;
+			size_t	n = logFormat(record, line, sizeof(line) - 1);
+
+			line[n++] = '\n';
+			if (len[stream] + n > sizeof(buf[stream]))
+				flushBuffer(stream, buf[stream], &len[stream]);
+			std::memcpy(buf[stream] + len[stream], line, n);
+			len[stream] += n;
+		}
+
+		if (state == RING_RETIRED)
+			ring.state.compare_exchange_strong(state, RING_FREE);
+	}
+
+	uint64_t	dropped = logDropped();
+	if (dropped != g_reportedDrops) {
+		int	n = snprintf(line, sizeof(line), "[LOG] %" PRIu64 " records dropped (%" PRIu64 " total)\n",
+				dropped - g_reportedDrops, dropped);
+		if (n > 0 && len[1] + static_cast<size_t>(n) > sizeof(buf[1]))
+			flushBuffer(1, buf[1], &len[1]);
+		if (n > 0) {
+			std::memcpy(buf[1] + len[1], line, static_cast<size_t>(n));
+			len[1] += static_cast<size_t>(n);
+		}
+		g_reportedDrops = dropped;
+	}
+
+	flushBuffer(0, buf[0], &len[0]);
+	flushBuffer(1, buf[1], &len[1]);
+}
+
+static void	writerLoop() {
+
+	while (g_writerRunning.load(std::memory_order_acquire)) {
+		drainRings();
+		std::this_thread::sleep_for(LOG_FLUSH_PERIOD);
+	}
+	drainRings();
+}
+
+int		logStart(int outFd, int errFd) {
+
+	if (g_writerRunning.exchange(true))
+		return (-1);
+
+	g_fds[0] = outFd;
+	g_fds[1] = errFd;
+	try {
+		g_writer = std::thread(writerLoop);
+	} catch (const std::system_error &) {
+		g_writerRunning.store(false);
+		return (-1);
+	}
+	return (0);
+}
+
+void	logStop() {
+
+	if (!g_writerRunning.exchange(false))
+		return ;
+	if (g_writer.joinable())
+		g_writer.join();
+}
@@ -0,0 +1,152 @@
+#include "LatencyHistogram.hpp"
+
+#include <cmath>
+
+static_assert(LatencyHistogram::MAX_BITS < 63, "MAX_BITS must leave room for the sign");
+
+size_t	LatencyHistogram::bucketOf(int64_t valueNs) noexcept {
+
+	if (valueNs < SUB_COUNT)
+		return (valueNs > 0 ? static_cast<size_t>(valueNs) : 0);
+
+	uint64_t	value = static_cast<uint64_t>(valueNs);
+	int			magnitude = 63 - __builtin_clzll(value);
+
+	if (magnitude >= MAX_BITS)
+		return (BUCKETS - 1);
+
+	// [2^magnitude, 2^(magnitude + 1)) keeps its top SUB_BITS bits
+	int			shift = magnitude - (SUB_BITS - 1);
+	int64_t		top = static_cast<int64_t>(value >> shift);
+
+	return (static_cast<size_t>(SUB_COUNT + (shift - 1) * HALF_COUNT + (top - HALF_COUNT)));
+}
+
+int64_t	LatencyHistogram::bucketLow(size_t bucket) noexcept {
+
+	if (bucket < static_cast<size_t>(SUB_COUNT))
+		return (static_cast<int64_t>(bucket));
+
+	int64_t	k = static_cast<int64_t>(bucket) - SUB_COUNT;
+	int64_t	top = HALF_COUNT + k % HALF_COUNT;
+
+	return (top << (k / HALF_COUNT + 1));
+}
+
+int64_t	LatencyHistogram::bucketHigh(size_t bucket) noexcept {
+
+	if (bucket < static_cast<size_t>(SUB_COUNT))
+		return (static_cast<int64_t>(bucket));
+
+	int64_t	k = static_cast<int64_t>(bucket) - SUB_COUNT;
+	int64_t	top = HALF_COUNT + k % HALF_COUNT;
+
+	return (((top + 1) << (k / HALF_COUNT + 1)) - 1);
+}
+
+void	LatencyHistogram::record(int64_t valueNs) noexcept {
+
+	if (valueNs < 0)
+		valueNs = 0;
+
+	_buckets[bucketOf(valueNs)].fetch_add(1, std::memory_order_relaxed);
+	_sumNs.fetch_add(valueNs, std::memory_order_relaxed);
+
+	int64_t	current = _minNs.load(std::memory_order_relaxed);
+	while (valueNs < current
+		&& !_minNs.compare_exchange_weak(current, valueNs, std::memory_order_relaxed))
+		;
+	current = _maxNs.load(std::memory_order_relaxed);
+	while (valueNs > current
+		&& !_maxNs.compare_exchange_weak(current, valueNs, std::memory_order_relaxed))
+		;
+	_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void	LatencyHistogram::reset() noexcept {
+
+	for (std::atomic<uint64_t> &bucket : _buckets)
+		bucket.store(0, std::memory_order_relaxed);
+	_count.store(0, std::memory_order_relaxed);
+	_sumNs.store(0, std::memory_order_relaxed);
+	_minNs.store(INT64_MAX, std::memory_order_relaxed);
+	_maxNs.store(0, std::memory_order_relaxed);
+}
+
+// Value of the rank-th smallest record, from a copy of the buckets
+int64_t	LatencyHistogram::valueAt(uint64_t rank, uint64_t total, const uint64_t *counts,
+			int64_t minNs, int64_t maxNs) const noexcept {
+
+	uint64_t	seen = 0;
+
+	// The 0th percentile is the exact minimum
+	if (rank == 0)
+		return (minNs);
+	if (rank > total)
+		rank = total;
+	for (size_t i = 0; i < BUCKETS; i++) {
+		seen += counts[i];
+		if (seen < rank)
+			continue ;
+		// The last bucket also holds everything above its range
+		int64_t	value = i == BUCKETS - 1 ? maxNs : bucketHigh(i);
+		if (value > maxNs)
+			value = maxNs;
+		return (value < minNs ? minNs : value);
+	}
+	return (maxNs);
+}
+
+// A record racing the read may be in its bucket before min and max
+void	LatencyHistogram::loadBounds(int64_t *minNs, int64_t *maxNs) const noexcept {
+
+	*minNs = _minNs.load(std::memory_order_relaxed);
+	*maxNs = _maxNs.load(std::memory_order_relaxed);
+	if (*minNs > *maxNs)
+		*minNs = *maxNs;
+}
+
+static uint64_t	rankOf(double percent, uint64_t total) {
+
+	return (static_cast<uint64_t>(std::ceil(percent / 100.0 * static_cast<double>(total))));
+}
+
+int64_t	LatencyHistogram::percentile(double percent) const noexcept {
+
+	uint64_t	counts[BUCKETS];
+	uint64_t	total = 0;
+	int64_t		minNs;
+	int64_t		maxNs;
+
+	for (size_t i = 0; i < BUCKETS; i++) {
+		counts[i] = _buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+	if (total == 0)
+		return (0);
+	loadBounds(&minNs, &maxNs);
+	return (valueAt(rankOf(percent, total), total, counts, minNs, maxNs));
+}
+
+void	LatencyHistogram::summarize(t_histogramSummary *summary) const noexcept {
+
+	uint64_t	counts[BUCKETS];
+	uint64_t	total = 0;
+
+	*summary = {};
+	for (size_t i = 0; i < BUCKETS; i++) {
+		counts[i] = _buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+	if (total == 0)
+		return ;
+
+	// The buckets are the reference, _count may be a record behind or ahead
+	summary->count = total;
+	loadBounds(&summary->minNs, &summary->maxNs);
+	summary->meanNs = _sumNs.load(std::memory_order_relaxed) / static_cast<int64_t>(total);
+	summary->p50Ns = valueAt(rankOf(50, total), total, counts, summary->minNs, summary->maxNs);
+	summary->p90Ns = valueAt(rankOf(90, total), total, counts, summary->minNs, summary->maxNs);
+	summary->p99Ns = valueAt(rankOf(99, total), total, counts, summary->minNs, summary->maxNs);
+	summary->p999Ns = valueAt(rankOf(99.9, total), total, counts, summary->minNs, summary->maxNs);
+}
@@ -0,0 +1,285 @@
+#include "StatsServer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+typedef struct s_statsEntry {
+	char					name[STATS_NAME_SIZE];
+	const LatencyHistogram	*histogram;		/**< nullptr if the slot is free */
+} t_statsEntry;
+
+// Registration is rare, the lock only keeps a query from reading a histogram being unregistered
+static std::mutex		g_registryLock;
+static t_statsEntry		g_entries[STATS_MAX_HISTOGRAMS];
+
+static std::thread		g_server;
+static int				g_listenFd = -1;
+static int				g_stopFd = -1;
+static std::string		g_path;
+
+int		statsRegister(const char *name, const LatencyHistogram *histogram) {
+
+	std::lock_guard<std::mutex>	lock(g_registryLock);
+	t_statsEntry				*free = nullptr;
+
+	if (!name || !histogram || !*name || std::strlen(name) >= STATS_NAME_SIZE
+		|| std::strchr(name, ' '))
+		return (-1);
+	for (t_statsEntry &entry : g_entries) {
+		if (entry.histogram && std::strcmp(entry.name, name) == 0)
+			return (-1);
+		if (!entry.histogram && !free)
+			free = &entry;
+	}
+	if (!free)
+		return (-1);
+	std::strcpy(free->name, name);
+	free->histogram = histogram;
+	return (0);
+}
+
+void	statsUnregister(const LatencyHistogram *histogram) {
+
+	std::lock_guard<std::mutex>	lock(g_registryLock);
+
+	for (t_statsEntry &entry : g_entries) {
+		if (entry.histogram == histogram)
+			entry.histogram = nullptr;
+	}
+}
+
+static void	appendf(std::string &out, const char *format, ...)
+	__attribute__((format(printf, 2, 3)));
+
+static void	appendf(std::string &out, const char *format, ...) {
+
+	char	line[256];
+	va_list	args;
+
+	va_start(args, format);
+	int	n = vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	if (n > 0)
+		out.append(line, std::min(static_cast<size_t>(n), sizeof(line) - 1));
+}
+
+static void	show(const std::string &prefix, std::string &out) {
+
+	t_histogramSummary	s;
+
+	appendf(out, "%-28s %10s %9s %9s %9s %9s %9s %9s %9s\n", "name (us)", "count",
+		"min", "mean", "p50", "p90", "p99", "p99.9", "max");
+	for (const t_statsEntry &entry : g_entries) {
+		if (!entry.histogram || std::strncmp(entry.name, prefix.c_str(), prefix.size()) != 0)
+			continue ;
+		entry.histogram->summarize(&s);
+		appendf(out, "%-28s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", entry.name,
+			static_cast<unsigned long long>(s.count), s.minNs / 1e3, s.meanNs / 1e3,
+			s.p50Ns / 1e3, s.p90Ns / 1e3, s.p99Ns / 1e3, s.p999Ns / 1e3, s.maxNs / 1e3);
+	}
+}
+
+static int	dump(const std::string &name, std::string &out) {
+
+	for (const t_statsEntry &entry : g_entries) {
+		if (!entry.histogram || name != entry.name)
+			continue ;
+		for (size_t i = 0; i < LatencyHistogram::BUCKETS; i++) {
+			uint64_t	count = entry.histogram->bucketCount(i);
+			if (count)
+				appendf(out, "%lld %lld %llu\n",
+					static_cast<long long>(LatencyHistogram::bucketLow(i)),
+					static_cast<long long>(LatencyHistogram::bucketHigh(i)),
+					static_cast<unsigned long long>(count));
+		}
+		return (0);
+	}
+	appendf(out, "unknown histogram '%s'\n", name.c_str());
+	return (-1);
+}
+
+int		statsCommand(const std::string &command, std::string &out) {
+
+	std::lock_guard<std::mutex>	lock(g_registryLock);
+	size_t						space = command.find(' ');
+	std::string					verb = command.substr(0, space);
+	std::string					arg = space == std::string::npos ? "" : command.substr(space + 1);
+
+	out.clear();
+	if (verb == "list" && arg.empty()) {
+		for (const t_statsEntry &entry : g_entries) {
+			if (entry.histogram)
+				appendf(out, "%s\n", entry.name);
+		}
+		return (0);
+	}
+	if (verb == "show") {
+		show(arg, out);
+		return (0);
+	}
+	if (verb == "dump" && !arg.empty())
+		return (dump(arg, out));
+	if (verb == "help" && arg.empty()) {
+		out = "list                 registered histograms\n"
+			"show [PREFIX]        summary in us of the histograms starting with PREFIX\n"
+			"dump NAME            lowNs highNs count of every non-empty bucket\n";
+		return (0);
+	}
+	appendf(out, "unknown command '%.64s', try help\n", command.c_str());
+	return (-1);
+}
+
+// Reads one line, a silent client is dropped after STATS_READ_TIMEOUT
+static bool	readCommand(int fd, std::string &command) {
+
+	char			buf[STATS_COMMAND_SIZE];
+	size_t			len = 0;
+	struct timeval	timeout = {};
+	auto			us = std::chrono::duration_cast<std::chrono::microseconds>(
+		STATS_READ_TIMEOUT).count();
+
+	timeout.tv_sec = us / 1000000;
+	timeout.tv_usec = us % 1000000;
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	while (len < sizeof(buf)) {
+		ssize_t	n = read(fd, buf + len, sizeof(buf) - len);
+		if (n < 0 && errno == EINTR)
+			continue ;
+		if (n <= 0)
+			break ;
+		len += static_cast<size_t>(n);
+		if (std::memchr(buf, '\n', len))
+			break ;
+	}
+	const char	*end = static_cast<const char*>(std::memchr(buf, '\n', len));
+	if (!end && len == sizeof(buf))
+		return (false);
+	command.assign(buf, end ? static_cast<size_t>(end - buf) : len);
+	if (!command.empty() && command.back() == '\r')
+		command.pop_back();
+	return (!command.empty());
+}
+
+static void	serve(int fd) {
+
+	std::string	command;
+	std::string	response;
+
+	if (readCommand(fd, command))
+		statsCommand(command, response);
+	else
+		response = "no command, try help\n";
+
+	size_t	done = 0;
+	while (done < response.size()) {
+		ssize_t	n = send(fd, response.data() + done, response.size() - done, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue ;
+		if (n <= 0)
+			break ;
+		done += static_cast<size_t>(n);
+	}
+}
+
+static void	serverLoop() {
+
+	struct pollfd	pfd[2];
+
+	pfd[0].fd = g_listenFd;
+	pfd[0].events = POLLIN;
+	pfd[1].fd = g_stopFd;
+	pfd[1].events = POLLIN;
+	while (true) {
+		if (poll(pfd, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue ;
+			perror("poll stats");
+			return ;
+		}
+		if (pfd[1].revents & POLLIN)
+			return ;
+		if (!(pfd[0].revents & POLLIN))
+			continue ;
+		int	client = accept4(g_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+		if (client < 0)
+			continue ;
+		serve(client);
+		close(client);
+	}
+}
+
+static void	closeServer() {
+
+	if (g_listenFd >= 0)
+		close(g_listenFd);
+	if (g_stopFd >= 0)
+		close(g_stopFd);
+	g_listenFd = -1;
+	g_stopFd = -1;
+}
+
+int		statsStart(const char *path) {
+
+	struct sockaddr_un	addr = {};
+
+	if (g_listenFd >= 0 || !path || std::strlen(path) >= sizeof(addr.sun_path))
+		return (-1);
+
+	addr.sun_family = AF_UNIX;
+	std::strcpy(addr.sun_path, path);
+	g_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	g_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (g_listenFd < 0 || g_stopFd < 0) {
+		perror("stats socket");
+		closeServer();
+		return (-1);
+	}
+
+	// Left behind by a process that did not exit cleanly
+	unlink(path);
+	if (bind(g_listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0
+		|| listen(g_listenFd, 4) < 0) {
+		fprintf(stderr, "Stats endpoint disabled, %s: %s\n", path, strerror(errno));
+		closeServer();
+		return (-1);
+	}
+
+	try {
+		g_server = std::thread(serverLoop);
+	} catch (const std::system_error &) {
+		closeServer();
+		unlink(path);
+		return (-1);
+	}
+	g_path = path;
+	return (0);
+}
+
+void	statsStop() {
+
+	uint64_t	one = 1;
+
+	if (g_server.joinable()) {
+		if (write(g_stopFd, &one, sizeof(one)) < 0)
+			perror("write stats eventfd");
+		g_server.join();
+		unlink(g_path.c_str());
+	}
+	closeServer();
+
+	std::lock_guard<std::mutex>	lock(g_registryLock);
+	for (t_statsEntry &entry : g_entries)
+		entry.histogram = nullptr;
+}
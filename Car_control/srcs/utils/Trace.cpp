@@ -0,0 +1,97 @@
+#include "Trace.hpp"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0,
+	"TRACE_BUFFER_SIZE must be a power of two");
+
+typedef struct s_traceBuffer {
+	std::atomic<bool>		claimed{false};
+	std::atomic<uint64_t>	count{0};	/**< Records ever written, wraps over the oldest */
+	t_traceRecord			records[TRACE_BUFFER_SIZE];
+} t_traceBuffer;
+
+// Zero initialized, locked in memory with the rest of .bss under --rt
+static t_traceBuffer			g_buffers[TRACE_MAX_THREADS];
+static std::atomic<uint32_t>	g_nextChain{1};
+static std::atomic<uint64_t>	g_unbuffered{0};
+
+static thread_local t_traceBuffer	*t_buffer = nullptr;
+static thread_local bool			t_claimed = false;
+static thread_local uint32_t		t_chain = 0;
+
+static const char	*g_stageNames[TRACE_STAGE_COUNT] = {
+	"evdev", "decode", "can_write", "tx_confirm"
+};
+
+const char	*traceStageName(e_traceStage stage) {
+
+	return (stage < TRACE_STAGE_COUNT ? g_stageNames[stage] : "unknown");
+}
+
+void	traceBegin() {
+
+	t_chain = g_nextChain.fetch_add(1, std::memory_order_relaxed);
+}
+
+void	traceRecord(e_traceStage stage, uint16_t canId, int64_t timestampNs) {
+
+	if (!t_claimed) {
+		t_claimed = true;
+		for (t_traceBuffer &buffer : g_buffers) {
+			bool	expected = false;
+			if (buffer.claimed.compare_exchange_strong(expected, true)) {
+				t_buffer = &buffer;
+				break ;
+			}
+		}
+	}
+	if (!t_buffer) {
+		g_unbuffered.fetch_add(1, std::memory_order_relaxed);
+		return ;
+	}
+
+	uint64_t		n = t_buffer->count.load(std::memory_order_relaxed);
+	t_traceRecord	&record = t_buffer->records[n & (TRACE_BUFFER_SIZE - 1)];
+
+	record.timestampNs = timestampNs;
+	record.chain = t_chain;
+	record.canId = canId;
+	record.stage = stage;
+	t_buffer->count.store(n + 1, std::memory_order_release);
+}
+
+long	traceDump(const char *path) {
+
+	FILE	*out = fopen(path, "w");
+	long	written = 0;
+
+	if (!out) {
+		perror(path);
+		return (-1);
+	}
+
+	fprintf(out, "thread,stage,canId,chain,timestampNs\n");
+	for (int t = 0; t < TRACE_MAX_THREADS; t++) {
+		const t_traceBuffer	&buffer = g_buffers[t];
+		uint64_t			count = buffer.count.load(std::memory_order_acquire);
+		uint64_t			first = count > TRACE_BUFFER_SIZE ? count - TRACE_BUFFER_SIZE : 0;
+
+		for (uint64_t i = first; i < count; i++) {
+			const t_traceRecord	&record = buffer.records[i & (TRACE_BUFFER_SIZE - 1)];
+			fprintf(out, "%d,%s,0x%x,%" PRIu32 ",%" PRId64 "\n", t,
+				traceStageName(static_cast<e_traceStage>(record.stage)),
+				record.canId, record.chain, record.timestampNs);
+			written++;
+		}
+	}
+
+	uint64_t	lost = g_unbuffered.load(std::memory_order_relaxed);
+	if (lost)
+		fprintf(stderr, "[TRACE] %" PRIu64 " records from threads without a buffer\n", lost);
+	if (fclose(out) != 0)
+		return (-1);
+	return (written);
+}
@@ -1,4 +1,6 @@
 #include "carControl.h"
+#include <sched.h>
+#include <sstream>
 
 std::string to_upper(const std::string &s) {
     std::string out = s;
@@ -20,6 +22,31 @@ static bool parseBool(std::string& value, bool defaultValue) {
 	return (defaultValue);
 }
 
+// Parse "CONTROL,RX,MONITOR" into one field of each thread profile
+static bool parseTriple(const std::string &value, t_rtProfile *rt, int t_threadProfile::*field,
+				int min, int max) {
+
+	t_threadProfile	*targets[3] = {&rt->control, &rt->rx, &rt->monitor};
+	std::stringstream	ss(value);
+	std::string			item;
+	int					parsed[3];
+	int					count = 0;
+
+	while (std::getline(ss, item, ',')) {
+		char	*end = nullptr;
+		long	n = std::strtol(item.c_str(), &end, 10);
+		if (count == 3 || item.empty() || *end != '\0' || n < min || n > max)
+			return (false);
+		parsed[count++] = static_cast<int>(n);
+	}
+	if (count != 3)
+		return (false);
+
+	for (int i = 0; i < 3; i++)
+		targets[i]->*field = parsed[i];
+	return (true);
+}
+
 // Parse command line arguments; can override default values
 // Mainly used for debugging
 int	parsingArgv(int argc, char *argv[], t_carControl *carControl) {
@@ -37,11 +64,89 @@ int	parsingArgv(int argc, char *argv[], t_carControl *carControl) {
 		} else if (arg.find("--can=") == 0) {
 			carControl->canInterface = arg.substr(6);
 			
+		// Parse --reactor=true|false
+		} else if (arg.find("--reactor=") == 0) {
+			std::string value = arg.substr(10);
+			carControl->reactor = parseBool(value, false);
+
+		// Parse --drive-rate=HZ
+		} else if (arg.find("--drive-rate=") == 0) {
+			std::string	value = arg.substr(13);
+			char		*end = nullptr;
+			long		hz = std::strtol(value.c_str(), &end, 10);
+			if (value.empty() || *end != '\0' || hz < 1 || hz > 1000) {
+				std::cerr << "Invalid --drive-rate value '" << value
+						  << "'. Use a rate in Hz between 1 and 1000" << std::endl;
+				carControl->exit = true;
+				return (0);
+			}
+			carControl->driveRateHz = static_cast<int>(hz);
+
+		// Parse --trace=PATH
+		} else if (arg.find("--trace=") == 0) {
+			carControl->tracePath = arg.substr(8);
+			if (carControl->tracePath.empty()) {
+				std::cerr << "Invalid --trace value. Use a file path" << std::endl;
+				carControl->exit = true;
+				return (0);
+			}
+
+		// Parse --tx-timestamps=true|false
+		} else if (arg.find("--tx-timestamps=") == 0) {
+			std::string value = arg.substr(16);
+			carControl->txTimestamps = parseBool(value, false);
+
+		// Parse --stats-socket=PATH|none
+		} else if (arg.find("--stats-socket=") == 0) {
+			std::string	value = arg.substr(15);
+			if (value.empty()) {
+				std::cerr << "Invalid --stats-socket value. Use a socket path or none" << std::endl;
+				carControl->exit = true;
+				return (0);
+			}
+			carControl->statsSocket = value == "none" ? "" : value;
+
+		// Parse --rt=true|false
+		} else if (arg.find("--rt=") == 0) {
+			std::string value = arg.substr(5);
+			carControl->rt.enabled = parseBool(value, false);
+
+		// Parse --rt-cpus=CONTROL,RX,MONITOR
+		} else if (arg.find("--rt-cpus=") == 0) {
+			if (!parseTriple(arg.substr(10), &carControl->rt, &t_threadProfile::cpu,
+					-1, CPU_SETSIZE - 1)) {
+				std::cerr << "Invalid --rt-cpus value '" << arg.substr(10)
+						  << "'. Use three cores, e.g. 3,2,2" << std::endl;
+				carControl->exit = true;
+				return (0);
+			}
+
+		// Parse --rt-prio=CONTROL,RX,MONITOR
+		} else if (arg.find("--rt-prio=") == 0) {
+			if (!parseTriple(arg.substr(10), &carControl->rt, &t_threadProfile::priority,
+					0, 99)) {
+				std::cerr << "Invalid --rt-prio value '" << arg.substr(10)
+						  << "'. Use three priorities (0-99), e.g. 80,85,90" << std::endl;
+				carControl->exit = true;
+				return (0);
+			}
+
 		// Parse --help
 		} else if (arg == "--help" || arg == "-h") {
 			std::cout << "Usage: " << argv[0] << " [options]\n"
 					  << "  --manual=true|false  Enable manual mode over autonomous (default: true)\n"
 					  << "  --can=INTERFACE   CAN interface (default: can0)\n"
+					  << "  --reactor=true|false  Single thread epoll loop instead of RX, monitor and control threads (default: false)\n"
+					  << "  --drive-rate=HZ   Driving command refresh rate (default: " << DRIVE_RATE_HZ << ")\n"
+					  << "  --trace=PATH      Write latency tracepoints as CSV on exit (ENABLE_TRACEPOINTS builds)\n"
+					  << "  --tx-timestamps=true|false  Measure write to TX echo latency per CAN ID (default: false)\n"
+					  << "  --stats-socket=PATH|none  Latency histograms endpoint for tools/carstats (default: "
+					  << STATS_SOCKET_PATH << ")\n"
+					  << "  --rt=true|false   Real-time profile: mlockall, SCHED_FIFO, pinning (default: false)\n"
+					  << "  --rt-cpus=C,R,M   Cores of control, RX and monitor threads, -1 unpinned (default: "
+					  << RT_CONTROL_CPU << "," << RT_RX_CPU << "," << RT_MONITOR_CPU << ")\n"
+					  << "  --rt-prio=C,R,M   SCHED_FIFO priorities, 0 for SCHED_OTHER (default: "
+					  << RT_CONTROL_PRIO << "," << RT_RX_PRIO << "," << RT_MONITOR_PRIO << ")\n"
 					  << "  --help            Show this help\n" << std::endl;
 			carControl->exit = true;
 			return (0);
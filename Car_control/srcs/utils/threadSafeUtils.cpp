@@ -1,26 +1,48 @@
 #include "carControl.h"
 
-// Thread-safe helper functions
-bool	getSpeedData(t_CANReceiver* receiver, t_speedData* data) {
+// Time since a sample was received, samples carry steady_clock timestamps
+static void	recordAge(LatencyHistogram &histogram, int64_t timestampNs) {
 
-	std::lock_guard<std::mutex> lock(receiver->speedMutex);
-	if (!receiver->speedQueue.empty()) {
+	if (!timestampNs)
+		return ;
+	histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count() - timestampNs);
+}
 
-		*data = receiver->speedQueue.front();
-		receiver->speedQueue.pop();
-		return (true);
-	}
-	return (false);
+// Lock-free helper functions, single consumer per queue
+bool	getSpeedData(t_CANReceiver* receiver, t_speedData* data) {
+
+	if (!receiver->speedQueue.pop(*data))
+		return (false);
+	recordAge(receiver->speedDwell, data->timestampNs);
+	return (true);
 }
 
 bool	getBatteryData(t_CANReceiver* receiver, t_batteryData* data) {
 
-	std::lock_guard<std::mutex> lock(receiver->batteryMutex);
-	if (!receiver->batteryQueue.empty()) {
+	if (!receiver->batteryQueue.pop(*data))
+		return (false);
+	recordAge(receiver->batteryDwell, data->timestampNs);
+	return (true);
+}
+
+// Latest value helpers, readable from any thread
+bool	getLatestSpeed(t_CANReceiver* receiver, t_speedSample* sample,
+			uint64_t* lastSequence) {
+
+	if (!receiver->speedMailbox.loadNewer(*sample, *lastSequence))
+		return (false);
+	*lastSequence = sample->sequence;
+	recordAge(receiver->speedAge, sample->timestampNs);
+	return (true);
+}
+
+bool	getLatestBattery(t_CANReceiver* receiver, t_batterySample* sample,
+			uint64_t* lastSequence) {
 
-		*data = receiver->batteryQueue.front();
-		receiver->batteryQueue.pop();
-		return (true);
-	}
-	return (false);
+	if (!receiver->batteryMailbox.loadNewer(*sample, *lastSequence))
+		return (false);
+	*lastSequence = sample->sequence;
+	recordAge(receiver->batteryAge, sample->timestampNs);
+	return (true);
 }
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "AsyncLogger.hpp"
+#include <fcntl.h>
+#include <string>
+#include <thread>
+
+/********************************/
+/*      ASYNC LOGGER TESTS      */
+/********************************/
+
+template <typename... Args>
+static std::string	format(t_logSite *site, const Args&... args) {
+
+	t_logRecord	record;
+	char		line[256];
+
+	record.site = site;
+	record.timestampNs = 0;
+	record.suppressed = 0;
+	record.argc = 0;
+	record.textUsed = 0;
+	(logPack(record, args), ...);
+	logFormat(record, line, sizeof(line));
+	return (std::string(line));
+}
+
+// Reads everything written to a pipe so far
+static std::string	drain(int fd) {
+
+	std::string	out;
+	char		buf[4096];
+	ssize_t		n;
+
+	while ((n = read(fd, buf, sizeof(buf))) > 0)
+		out.append(buf, static_cast<size_t>(n));
+	return (out);
+}
+
+TEST(AsyncLoggerTest, FormatsArguments) {
+
+	t_logSite numbers = {"a={} b={} c={x} d={}", LOG_OUT, 0, {0}, {0}};
+	t_logSite text = {"[{}] {}: {}", LOG_ERR, 0, {0}, {0}};
+	t_logSite missing = {"{} and {}", LOG_OUT, 0, {0}, {0}};
+
+	EXPECT_EQ(format(&numbers, -12, 7u, 0x201u, 2.5f), "a=-12 b=7 c=201 d=2.5");
+	EXPECT_EQ(format(&text, "MONITOR", std::string("error"), true), "[MONITOR] error: 1");
+	EXPECT_EQ(format(&missing, 1), "1 and {}");
+}
+
+// Strings share LOG_TEXT_SIZE bytes, the overflow is truncated, not written past
+TEST(AsyncLoggerTest, TruncatesLongText) {
+
+	t_logSite site = {"{}|{}|{}", LOG_OUT, 0, {0}, {0}};
+	std::string longText(200, 'x');
+
+	std::string line = format(&site, longText, "tail", longText);
+	EXPECT_EQ(line, std::string(LOG_TEXT_SIZE - 1, 'x') + "||");
+}
+
+// A rate limited site accepts one call per interval and counts the others
+TEST(AsyncLoggerTest, RateLimitsPerSite) {
+
+	t_logSite site = {"tick", LOG_OUT, 1000, {0}, {0}};
+	uint32_t suppressed = 0;
+
+	EXPECT_TRUE(logAdmit(&site, 5000, &suppressed));
+	EXPECT_EQ(suppressed, 0u);
+	for (int i = 1; i <= 9; i++)
+		EXPECT_FALSE(logAdmit(&site, 5000 + i * 100, &suppressed));
+	EXPECT_TRUE(logAdmit(&site, 6000, &suppressed));
+	EXPECT_EQ(suppressed, 9u);
+
+	t_logRecord record = {};
+	record.site = &site;
+	record.suppressed = suppressed;
+	char line[64];
+	logFormat(record, line, sizeof(line));
+	EXPECT_STREQ(line, "tick [+9 suppressed]");
+}
+
+// Records reach their stream through the background writer
+TEST(AsyncLoggerTest, WritesFromManyThreads) {
+
+	int out[2];
+	int err[2];
+	ASSERT_EQ(pipe2(out, O_NONBLOCK), 0);
+	ASSERT_EQ(pipe2(err, O_NONBLOCK), 0);
+	ASSERT_EQ(logStart(out[1], err[1]), 0);
+	EXPECT_EQ(logStart(out[1], err[1]), -1);
+
+	uint64_t droppedBefore = logDropped();
+
+	// More threads than rings over time: rings of exited threads are reused
+	for (int round = 0; round < 3 * LOG_MAX_THREADS; round++) {
+		std::thread worker([round]() {
+			LOG_INFO("worker {} line {}", round, 1);
+			LOG_ERROR("worker {} failed: {}", round, "boom");
+		});
+		worker.join();
+	}
+	for (int i = 0; i < 100; i++)
+		LOG_EVERY(std::chrono::seconds(10), LOG_OUT, "limited {}", i);
+	logStop();
+
+	std::string stdoutText = drain(out[0]);
+	std::string stderrText = drain(err[0]);
+	for (int fd : {out[0], out[1], err[0], err[1]})
+		close(fd);
+
+	for (int round = 0; round < 3 * LOG_MAX_THREADS; round++) {
+		EXPECT_NE(stdoutText.find("worker " + std::to_string(round) + " line 1\n"),
+			std::string::npos) << round;
+		EXPECT_NE(stderrText.find("worker " + std::to_string(round) + " failed: boom\n"),
+			std::string::npos) << round;
+	}
+	EXPECT_NE(stdoutText.find("limited 0\n"), std::string::npos);
+	EXPECT_EQ(stdoutText.find("limited 1"), std::string::npos);
+	EXPECT_EQ(logDropped(), droppedBefore);
+}
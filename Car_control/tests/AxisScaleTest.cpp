@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "Joystick.hpp"
+
+/********************************/
+/*   JOYSTICK AXIS SCALE TESTS  */
+/********************************/
+
+// Reference: the division based normalization getAbs() used before the table
+static int16_t	divideAxis(int axis_code, int32_t minimum, int32_t maximum, int32_t value) {
+
+	int range = maximum - minimum;
+	if (axis_code == ABS_Z) {
+		int normalized = ((value - minimum) * 180) / range;
+		return static_cast<int16_t>(std::clamp(normalized, 0, 180));
+	}
+	int center = (maximum + minimum) / 2;
+	int normalized = ((center - value) * 200) / range;
+	return static_cast<int16_t>(std::clamp(normalized, -100, 100));
+}
+
+// Every in-range value of common gamepad ranges matches the division
+TEST(AxisScaleTest, MatchesDivisionOverFullRange) {
+
+	const int32_t limits[][2] = {
+		{0, 255}, {0, 1023}, {-32768, 32767}, {0, 65535}, {-511, 512}, {0, 7}
+	};
+
+	for (const auto &limit : limits) {
+		for (int axis : {ABS_Z, ABS_Y, ABS_X}) {
+			t_axisScale scale = makeAxisScale(axis, limit[0], limit[1]);
+			ASSERT_TRUE(scale.present);
+			for (int32_t v = limit[0]; v <= limit[1]; v++)
+				ASSERT_EQ(scaleAxis(scale, v), divideAxis(axis, limit[0], limit[1], v))
+					<< "axis " << axis << " range " << limit[0] << ".." << limit[1]
+					<< " value " << v;
+		}
+	}
+}
+
+// Worst case for the reciprocal error: the largest supported range, sampled
+TEST(AxisScaleTest, MatchesDivisionAtMaxRange) {
+
+	const int32_t maximum = AXIS_MAX_RANGE;
+
+	for (int axis : {ABS_Z, ABS_Y}) {
+		t_axisScale scale = makeAxisScale(axis, 0, maximum);
+		ASSERT_TRUE(scale.present);
+		for (int32_t v = 0; v <= maximum; v += 997)
+			ASSERT_EQ(scaleAxis(scale, v), divideAxis(axis, 0, maximum, v)) << v;
+		EXPECT_EQ(scaleAxis(scale, maximum), divideAxis(axis, 0, maximum, maximum));
+	}
+}
+
+// Values reported outside absinfo limits clamp instead of overflowing
+TEST(AxisScaleTest, ClampsOutOfRangeValues) {
+
+	t_axisScale steering = makeAxisScale(ABS_Z, 0, 255);
+	t_axisScale throttle = makeAxisScale(ABS_Y, 0, 255);
+
+	EXPECT_EQ(scaleAxis(steering, -1000), 0);
+	EXPECT_EQ(scaleAxis(steering, INT32_MAX), 180);
+	EXPECT_EQ(scaleAxis(throttle, INT32_MIN), 100);
+	EXPECT_EQ(scaleAxis(throttle, INT32_MAX), -100);
+}
+
+// Empty or oversized ranges are not usable axes
+TEST(AxisScaleTest, RejectsUnusableRanges) {
+
+	EXPECT_FALSE(makeAxisScale(ABS_Y, 10, 10).present);
+	EXPECT_FALSE(makeAxisScale(ABS_Y, 10, 0).present);
+	EXPECT_FALSE(makeAxisScale(ABS_Y, 0, AXIS_MAX_RANGE + 1).present);
+	EXPECT_FALSE(makeAxisScale(ABS_Y, INT32_MIN, INT32_MAX).present);
+}
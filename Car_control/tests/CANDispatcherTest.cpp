@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "CANDispatcher.hpp"
+#include "carControl.h"
+
+/********************************/
+/*   CAN DISPATCHER TESTS       */
+/********************************/
+
+// Records the last frame it was called with
+typedef struct s_handlerProbe {
+	int			calls = 0;
+	canid_t		lastId = 0;
+	int64_t		lastTimestamp = 0;
+} t_handlerProbe;
+
+static void	probeHandler(const struct can_frame &frame, int64_t timestampNs, void *ctx) {
+
+	t_handlerProbe *probe = static_cast<t_handlerProbe*>(ctx);
+	probe->calls++;
+	probe->lastId = frame.can_id;
+	probe->lastTimestamp = timestampNs;
+}
+
+static struct can_frame	makeFrame(canid_t id) {
+
+	struct can_frame frame{};
+	frame.can_id = id;
+	return (frame);
+}
+
+// Frames reach the handler registered for their ID, with its context
+TEST(CANDispatcherTest, DispatchToRegisteredHandler) {
+
+	auto dispatcher = std::make_unique<CANDispatcher>();
+	t_handlerProbe first;
+	t_handlerProbe second;
+
+	ASSERT_EQ(dispatcher->registerHandler(0x200, probeHandler, &first), 0);
+	ASSERT_EQ(dispatcher->registerHandler(0x7FF, probeHandler, &second), 0);
+
+	EXPECT_TRUE(dispatcher->dispatch(makeFrame(0x200), 42));
+	EXPECT_EQ(first.calls, 1);
+	EXPECT_EQ(first.lastId, 0x200u);
+	EXPECT_EQ(first.lastTimestamp, 42);
+	EXPECT_EQ(second.calls, 0);
+
+	EXPECT_TRUE(dispatcher->dispatch(makeFrame(0x7FF), 43));
+	EXPECT_EQ(second.calls, 1);
+}
+
+// Unknown, extended, RTR and error frames are not dispatched
+TEST(CANDispatcherTest, UnknownAndNonStandardFrames) {
+
+	auto dispatcher = std::make_unique<CANDispatcher>();
+	t_handlerProbe probe;
+
+	ASSERT_EQ(dispatcher->registerHandler(0x200, probeHandler, &probe), 0);
+
+	EXPECT_FALSE(dispatcher->dispatch(makeFrame(0x201), 0));
+	EXPECT_FALSE(dispatcher->dispatch(makeFrame(0x200 | CAN_EFF_FLAG), 0));
+	EXPECT_FALSE(dispatcher->dispatch(makeFrame(0x200 | CAN_RTR_FLAG), 0));
+	EXPECT_FALSE(dispatcher->dispatch(makeFrame(0x200 | CAN_ERR_FLAG), 0));
+	EXPECT_EQ(probe.calls, 0);
+}
+
+// Invalid and duplicate registrations are rejected
+TEST(CANDispatcherTest, InvalidRegistration) {
+
+	auto dispatcher = std::make_unique<CANDispatcher>();
+	t_handlerProbe probe;
+
+	EXPECT_EQ(dispatcher->registerHandler(0x800, probeHandler, &probe), -1);
+	EXPECT_EQ(dispatcher->registerHandler(0x200, nullptr, &probe), -1);
+	EXPECT_EQ(dispatcher->registerHandler(0x200, probeHandler, &probe), 0);
+	EXPECT_EQ(dispatcher->registerHandler(0x200, probeHandler, &probe), -1);
+
+	// Freed again after unregistering
+	dispatcher->unregisterHandler(0x200);
+	EXPECT_FALSE(dispatcher->dispatch(makeFrame(0x200), 0));
+	EXPECT_EQ(dispatcher->registerHandler(0x200, probeHandler, &probe), 0);
+}
+
+// Registered IDs are listed in ascending order for the kernel filter
+TEST(CANDispatcherTest, SubscribedIds) {
+
+	auto dispatcher = std::make_unique<CANDispatcher>();
+	t_handlerProbe probe;
+	uint16_t ids[4];
+
+	EXPECT_EQ(dispatcher->subscribedIds(ids, 4), 0u);
+
+	dispatcher->registerHandler(0x300, probeHandler, &probe);
+	dispatcher->registerHandler(0x100, probeHandler, &probe);
+	dispatcher->registerHandler(0x200, probeHandler, &probe);
+
+	ASSERT_EQ(dispatcher->subscribedIds(ids, 4), 3u);
+	EXPECT_EQ(ids[0], 0x100);
+	EXPECT_EQ(ids[1], 0x200);
+	EXPECT_EQ(ids[2], 0x300);
+
+	// Total is reported even when the output is too small
+	EXPECT_EQ(dispatcher->subscribedIds(ids, 1), 3u);
+	EXPECT_EQ(ids[0], 0x100);
+}
+
+// Receiver handlers decode STM32 frames into the queues and mailboxes
+TEST(CANDispatcherTest, ReceiverHandlers) {
+
+	auto receiver = std::make_unique<t_CANReceiver>();
+	receiver->queueSamples = true;
+	ASSERT_EQ(registerReceiverHandlers(receiver.get()), 0);
+
+	uint16_t ids[4];
+	ASSERT_EQ(receiver->dispatcher.subscribedIds(ids, 4), 2u);
+	EXPECT_EQ(ids[0], CANRECEIVERID::SPEEDRPMSTM32);
+	EXPECT_EQ(ids[1], CANRECEIVERID::BATTERYSTM32);
+
+	struct can_frame speed = makeFrame(CANRECEIVERID::SPEEDRPMSTM32);
+	speed.can_dlc = 2;
+	speed.data[0] = 0x01;
+	speed.data[1] = 0x02;
+	EXPECT_TRUE(receiver->dispatcher.dispatch(speed, 7));
+
+	t_speedData speedData;
+	ASSERT_TRUE(getSpeedData(receiver.get(), &speedData));
+	EXPECT_EQ(speedData.rpm, 0x0102);
+
+	// Short frames are ignored by the decoder
+	struct can_frame battery = makeFrame(CANRECEIVERID::BATTERYSTM32);
+	battery.can_dlc = 2;
+	EXPECT_TRUE(receiver->dispatcher.dispatch(battery, 8));
+	EXPECT_TRUE(receiver->batteryQueue.empty());
+	EXPECT_EQ(receiver->batteryMailbox.sequence(), 0u);
+}
@@ -70,6 +70,25 @@ TEST_F(CANProtocolTest, VerifyCANIDs) {
 	EXPECT_EQ(CANSENDID::DRIVING_COMMAND, 0x101);
 }
 
+// Test prebuilt emergency brake frames
+TEST_F(CANProtocolTest, EmergencyBrakeFramesPrebuilt) {
+	EXPECT_EQ(CANProtocol::EMERGENCY_BRAKE_ON.can_id, CANSENDID::EMERGENCY_BRAKE);
+	EXPECT_EQ(CANProtocol::EMERGENCY_BRAKE_ON.len, 1);
+	EXPECT_EQ(CANProtocol::EMERGENCY_BRAKE_ON.data[0], 0x0F);
+
+	EXPECT_EQ(CANProtocol::EMERGENCY_BRAKE_OFF.can_id, CANSENDID::EMERGENCY_BRAKE);
+	EXPECT_EQ(CANProtocol::EMERGENCY_BRAKE_OFF.len, 1);
+	EXPECT_EQ(CANProtocol::EMERGENCY_BRAKE_OFF.data[0], 0x00);
+}
+
+// Test emergency brake on an uninitialized controller
+TEST_F(CANProtocolTest, SendEmergencyBrakeAfterCleanupThrows) {
+	CANController can(validInterface);
+	can.cleanup();
+
+	EXPECT_THROW(CANProtocol::sendEmergencyBrake(can, true), CANController::CANException);
+}
+
 // Test emergency brake data encoding using system candump
 TEST_F(CANProtocolTest, EmergencyBrakeDataEncodingActive) {
 	// Start candump in background before sending
@@ -204,3 +223,33 @@ TEST_F(CANProtocolTest, AlternatingCommands) {
 		}
 	}
 }
+
+// One-shot brakes never latch the kernel heartbeat to the brake state
+TEST_F(CANProtocolTest, HeartbeatIndependentOfEmergencyBrake) {
+	CANController can(validInterface);
+	CANController receiver(validInterface);
+
+	uint16_t id = CANSENDID::EMERGENCY_BRAKE;
+	receiver.setReceiveFilter(&id, 1);
+
+	if (!CANProtocol::startCyclicBrake(can, false, std::chrono::milliseconds(20)))
+		GTEST_SKIP() << "CAN_BCM not available";
+
+	struct can_frame rx;
+	ASSERT_EQ(receiver.receiveFrameBlocking(&rx, 1000), 0);
+	EXPECT_EQ(rx.data[0], 0x00);
+
+	// Brake then release, the repetitions after each command stay OFF
+	for (bool active : {true, false}) {
+		CANProtocol::sendEmergencyBrake(can, active);
+		if (active) {
+			ASSERT_EQ(receiver.receiveFrameBlocking(&rx, 1000), 0);
+			while (rx.data[0] != 0x0F)
+				ASSERT_EQ(receiver.receiveFrameBlocking(&rx, 1000), 0);
+		}
+		for (int i = 0; i < 3; i++) {
+			ASSERT_EQ(receiver.receiveFrameBlocking(&rx, 1000), 0);
+			EXPECT_EQ(rx.data[0], 0x00);
+		}
+	}
+}
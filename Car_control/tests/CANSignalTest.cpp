@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "CANMessages.hpp"
+#include "CANProtocol.hpp"
+#include <memory>
+
+/********************************/
+/*   CAN SIGNAL CODEC TESTS     */
+/********************************/
+
+// Little-endian signals at arbitrary bit positions
+TEST(CANSignalTest, LittleEndianExtraction) {
+
+	const uint8_t data[8] = {0xAB, 0xCD, 0xEF, 0x01, 0, 0, 0, 0};
+
+	EXPECT_EQ((CANSignal<uint16_t, 0, 16>::decode(data)), 0xCDAB);
+	EXPECT_EQ((CANSignal<uint8_t, 4, 8>::decode(data)), 0xDA);
+	EXPECT_EQ((CANSignal<uint8_t, 0, 4>::decode(data)), 0x0B);
+	EXPECT_EQ((CANSignal<uint32_t, 8, 24>::decode(data)), 0x01EFCDu);
+}
+
+// Big-endian (Motorola) signals, start bit is the MSB like in DBC files
+TEST(CANSignalTest, BigEndianExtraction) {
+
+	const uint8_t data[8] = {0x12, 0x34, 0x56, 0, 0, 0, 0, 0};
+
+	// MSB of data[0] is bit 7
+	EXPECT_EQ((CANSignal<uint16_t, 7, 16, ByteOrder::BigEndian>::decode(data)), 0x1234);
+	EXPECT_EQ((CANSignal<uint16_t, 15, 16, ByteOrder::BigEndian>::decode(data)), 0x3456);
+	EXPECT_EQ((CANSignal<uint8_t, 3, 8, ByteOrder::BigEndian>::decode(data)), 0x23);
+}
+
+// Signed signals are sign extended from their own length
+TEST(CANSignalTest, SignExtension) {
+
+	uint8_t data[8] = {};
+
+	CANSignal<int8_t, 0, 4>::encode(data, -3);
+	EXPECT_EQ(data[0], 0x0D);
+	EXPECT_EQ((CANSignal<int8_t, 0, 4>::decode(data)), -3);
+
+	CANSignal<int16_t, 16, 12, ByteOrder::BigEndian>::encode(data, -100);
+	EXPECT_EQ((CANSignal<int16_t, 16, 12, ByteOrder::BigEndian>::decode(data)), -100);
+	EXPECT_EQ((CANSignal<int8_t, 0, 4>::decode(data)), -3);
+}
+
+// Scale and offset are applied on both sides
+TEST(CANSignalTest, ScaleAndOffset) {
+
+	typedef CANSignal<float, 0, 16, ByteOrder::LittleEndian,
+		std::ratio<1, 10>, std::ratio<-40>>	Temperature;
+	typedef CANSignal<int32_t, 16, 8, ByteOrder::LittleEndian,
+		std::ratio<5>, std::ratio<100>>		Current;
+
+	uint8_t data[8] = {};
+	Temperature::encode(data, 25.3f);
+	EXPECT_EQ(Temperature::raw(data), 653);
+	EXPECT_NEAR(Temperature::decode(data), 25.3f, 0.05f);
+
+	Current::encode(data, 200);
+	EXPECT_EQ(Current::raw(data), 20);
+	EXPECT_EQ(Current::decode(data), 200);
+	EXPECT_EQ(Temperature::raw(data), 653);
+}
+
+// Layout checker rejects overlaps and signals past the DLC
+TEST(CANSignalTest, LayoutValidation) {
+
+	typedef CANSignal<uint8_t, 0, 8>	A;
+	typedef CANSignal<uint8_t, 8, 8>	B;
+	typedef CANSignal<uint8_t, 4, 8>	Overlap;
+
+	EXPECT_TRUE((validLayout<2, A, B>()));
+	EXPECT_FALSE((validLayout<1, A, B>()));
+	EXPECT_FALSE((validLayout<2, A, Overlap>()));
+	EXPECT_FALSE((validLayout<9, A>()));
+}
+
+// Message layouts shared by TX and RX
+TEST(CANSignalTest, ProtocolMessages) {
+
+	// Driving command keeps the historical little-endian layout
+	uint8_t data[8] = {};
+	CANMSG::DRIVING_COMMAND::Throttle::encode(data, 1000);
+	CANMSG::DRIVING_COMMAND::Steering::encode(data, -750);
+	EXPECT_EQ(data[0], 0xE8);
+	EXPECT_EQ(data[1], 0x03);
+	EXPECT_EQ(data[2], 0x12);
+	EXPECT_EQ(data[3], 0xFD);
+
+	// Emergency brake frames are built with the codec
+	EXPECT_EQ(CANProtocol::EMERGENCY_BRAKE_ON.data[0], 0x0F);
+	EXPECT_EQ(CANProtocol::EMERGENCY_BRAKE_ON.len, CANMSG::EMERGENCY_BRAKE::DLC);
+
+	// Received messages keep the big-endian layout of the STM32
+	const uint8_t speed[8] = {0x03, 0xE8};
+	EXPECT_EQ(CANMSG::SPEED::Rpm::decode(speed), 1000);
+}
+
+// Whole-message helpers generated from dbc/vehicle.dbc
+TEST(CANSignalTest, GeneratedPackUnpack) {
+
+	uint8_t data[8] = {};
+	CANMSG::DRIVING_COMMAND::pack(data, {-1500, 300});
+	EXPECT_EQ(CANMSG::DRIVING_COMMAND::unpack(data).Throttle, -1500);
+	EXPECT_EQ(CANMSG::DRIVING_COMMAND::unpack(data).Steering, 300);
+
+	const uint8_t battery[8] = {0x00, 0x50, 0x0C};
+	EXPECT_EQ(CANMSG::BATTERY::unpack(battery).Percentage, 0x50);
+	EXPECT_EQ(CANMSG::BATTERY::unpack(battery).Voltage, 0x0C);
+
+	// Only the messages received by RPI get a handler
+	auto dispatcher = std::make_unique<CANDispatcher>();
+	uint16_t ids[4];
+	EXPECT_EQ(CANMSG::registerRxHandlers(*dispatcher, nullptr), 0);
+	ASSERT_EQ(dispatcher->subscribedIds(ids, 4), CANMSG::RX_COUNT);
+	EXPECT_EQ(ids[0], CANMSG::SPEED::ID);
+	EXPECT_EQ(ids[1], CANMSG::BATTERY::ID);
+}
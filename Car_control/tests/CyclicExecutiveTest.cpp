@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+#include "CyclicExecutive.hpp"
+#include <thread>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <vector>
+
+/********************************/
+/*   CYCLIC EXECUTIVE TESTS     */
+/********************************/
+
+// Counts releases, stops the executive after a given number of them
+typedef struct s_taskProbe {
+	CyclicExecutive		*executive = nullptr;
+	int					id = 0;
+	int					calls = 0;
+	int					stopAfter = 0;
+	std::chrono::milliseconds	busy{0};
+	int					busyOn = -1;
+	std::vector<int>	*order = nullptr;
+} t_taskProbe;
+
+static void	probeTask(void *ctx) {
+
+	t_taskProbe *probe = static_cast<t_taskProbe*>(ctx);
+
+	probe->calls++;
+	if (probe->order)
+		probe->order->push_back(probe->id);
+	if (probe->calls == probe->busyOn)
+		std::this_thread::sleep_for(probe->busy);
+	if (probe->stopAfter && probe->calls >= probe->stopAfter)
+		probe->executive->stop();
+}
+
+// Releases follow absolute deadlines: N releases take (N - 1) periods
+TEST(CyclicExecutiveTest, RunsAtPeriod) {
+
+	CyclicExecutive executive;
+	std::atomic<bool> running{true};
+	t_taskProbe probe;
+	probe.executive = &executive;
+	probe.stopAfter = 21;
+
+	ASSERT_EQ(executive.addTask("probe", probeTask, &probe, std::chrono::milliseconds(5)), 0);
+
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_EQ(executive.run(running), 0);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	EXPECT_EQ(probe.calls, 21);
+	EXPECT_GE(elapsed, std::chrono::milliseconds(100));
+	EXPECT_LT(elapsed, std::chrono::milliseconds(1000));
+
+	const t_taskStats &stats = executive.stats(0);
+	EXPECT_EQ(stats.runs, 21u);
+	EXPECT_GE(stats.maxJitterNs, 0);
+	EXPECT_GE(stats.wcetNs, stats.lastExecNs);
+
+	// Every start delay also lands in the jitter histogram
+	EXPECT_EQ(executive.jitter(0).count(), 21u);
+	EXPECT_EQ(executive.jitter(0).percentile(100), stats.maxJitterNs);
+}
+
+// Phases order the releases of tasks sharing a period
+TEST(CyclicExecutiveTest, PhaseOrdersTasks) {
+
+	CyclicExecutive executive;
+	std::atomic<bool> running{true};
+	std::vector<int> order;
+	t_taskProbe late;
+	t_taskProbe early;
+	late.id = 1;
+	late.order = &order;
+	late.executive = &executive;
+	late.stopAfter = 3;
+	early.id = 2;
+	early.order = &order;
+
+	ASSERT_EQ(executive.addTask("late", probeTask, &late, std::chrono::milliseconds(20),
+		std::chrono::milliseconds(10)), 0);
+	ASSERT_EQ(executive.addTask("early", probeTask, &early, std::chrono::milliseconds(20)), 1);
+	EXPECT_EQ(executive.run(running), 0);
+
+	ASSERT_GE(order.size(), 2u);
+	EXPECT_EQ(order[0], 2);
+	EXPECT_EQ(order[1], 1);
+	EXPECT_EQ(late.calls, 3);
+
+	// A loaded machine may delay a wakeup past the next release (skipped, see CountsOverruns)
+	if (executive.stats(0).overruns || executive.stats(1).overruns)
+		return ;
+	ASSERT_EQ(order.size(), 6u);
+	for (size_t i = 0; i < order.size(); i++)
+		EXPECT_EQ(order[i], i % 2 == 0 ? 2 : 1);
+}
+
+// A release running past the next deadlines counts overruns and skips them
+TEST(CyclicExecutiveTest, CountsOverruns) {
+
+	CyclicExecutive executive;
+	std::atomic<bool> running{true};
+	t_taskProbe probe;
+	probe.executive = &executive;
+	probe.stopAfter = 5;
+	probe.busyOn = 2;
+	probe.busy = std::chrono::milliseconds(25);
+
+	ASSERT_EQ(executive.addTask("probe", probeTask, &probe, std::chrono::milliseconds(10)), 0);
+	EXPECT_EQ(executive.run(running), 0);
+
+	const t_taskStats &stats = executive.stats(0);
+	EXPECT_EQ(probe.calls, 5);
+	EXPECT_GE(stats.overruns, 2u);
+	EXPECT_GE(stats.wcetNs, 25000000);
+}
+
+// Stop and the running flag both end run() without waiting for a long period
+TEST(CyclicExecutiveTest, StopsPromptly) {
+
+	// Test 1: stop() from another thread interrupts the wait
+	{
+		CyclicExecutive executive;
+		std::atomic<bool> running{true};
+		t_taskProbe probe;
+
+		ASSERT_EQ(executive.addTask("slow", probeTask, &probe, std::chrono::seconds(10)), 0);
+		std::thread stopper([&executive]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			executive.stop();
+		});
+
+		auto start = std::chrono::steady_clock::now();
+		EXPECT_EQ(executive.run(running), 0);
+		stopper.join();
+
+		EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+		EXPECT_EQ(probe.calls, 1);
+	}
+
+	// Test 2: A cleared flag never releases anything
+	{
+		CyclicExecutive executive;
+		std::atomic<bool> running{false};
+		t_taskProbe probe;
+
+		ASSERT_EQ(executive.addTask("probe", probeTask, &probe, std::chrono::milliseconds(1)), 0);
+		EXPECT_EQ(executive.run(running), 0);
+		EXPECT_EQ(probe.calls, 0);
+	}
+}
+
+// Drains the eventfd of an input and stops the executive
+typedef struct s_inputProbe {
+	CyclicExecutive	*executive = nullptr;
+	int				fd = -1;
+	int				calls = 0;
+	std::chrono::steady_clock::time_point	at;
+} t_inputProbe;
+
+static void	inputTask(void *ctx) {
+
+	t_inputProbe	*probe = static_cast<t_inputProbe*>(ctx);
+	uint64_t		value;
+
+	probe->calls++;
+	probe->at = std::chrono::steady_clock::now();
+	if (read(probe->fd, &value, sizeof(value)) < 0)
+		return ;
+	probe->executive->stop();
+}
+
+// A readable input runs its task at once, not at the next release
+TEST(CyclicExecutiveTest, InputWakesBeforeRelease) {
+
+	CyclicExecutive executive;
+	std::atomic<bool> running{true};
+	t_taskProbe periodic;
+	t_inputProbe input;
+	input.executive = &executive;
+	input.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	ASSERT_GE(input.fd, 0);
+
+	ASSERT_EQ(executive.addTask("slow", probeTask, &periodic, std::chrono::seconds(10)), 0);
+	ASSERT_EQ(executive.addInput("events", input.fd, inputTask, &input), 0);
+
+	std::chrono::steady_clock::time_point written;
+	std::thread writer([&input, &written]() {
+		uint64_t one = 1;
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		written = std::chrono::steady_clock::now();
+		EXPECT_EQ(write(input.fd, &one, sizeof(one)), static_cast<ssize_t>(sizeof(one)));
+	});
+
+	EXPECT_EQ(executive.run(running), 0);
+	writer.join();
+	close(input.fd);
+
+	EXPECT_EQ(input.calls, 1);
+	EXPECT_EQ(executive.inputWakeups(0), 1u);
+	EXPECT_EQ(periodic.calls, 1);	// only the release at start
+	EXPECT_LT(input.at - written, std::chrono::milliseconds(500));
+}
+
+// A hung up input is reported once, then no longer watched
+TEST(CyclicExecutiveTest, InputHangupRunsOnce) {
+
+	CyclicExecutive executive;
+	std::atomic<bool> running{true};
+	t_taskProbe periodic;
+	t_taskProbe hangup;
+	int pipeFds[2];
+
+	ASSERT_EQ(pipe(pipeFds), 0);
+	close(pipeFds[1]);
+	periodic.executive = &executive;
+	periodic.stopAfter = 5;
+
+	ASSERT_EQ(executive.addTask("probe", probeTask, &periodic, std::chrono::milliseconds(5)), 0);
+	ASSERT_EQ(executive.addInput("dead", pipeFds[0], probeTask, &hangup), 0);
+	EXPECT_EQ(executive.run(running), 0);
+	close(pipeFds[0]);
+
+	EXPECT_EQ(periodic.calls, 5);
+	EXPECT_EQ(hangup.calls, 1);
+}
+
+TEST(CyclicExecutiveTest, InvalidRegistration) {
+
+	CyclicExecutive executive;
+	std::atomic<bool> running{true};
+	t_taskProbe probe;
+
+	EXPECT_EQ(executive.run(running), -1);
+	EXPECT_EQ(executive.addTask("null", nullptr, &probe, std::chrono::milliseconds(1)), -1);
+	EXPECT_EQ(executive.addTask("zero", probeTask, &probe, std::chrono::milliseconds(0)), -1);
+	EXPECT_EQ(executive.addTask("phase", probeTask, &probe, std::chrono::milliseconds(1),
+		std::chrono::milliseconds(-1)), -1);
+
+	for (size_t i = 0; i < CyclicExecutive::MAX_TASKS; i++)
+		EXPECT_EQ(executive.addTask("probe", probeTask, &probe, std::chrono::milliseconds(1)),
+			static_cast<int>(i));
+	EXPECT_EQ(executive.addTask("full", probeTask, &probe, std::chrono::milliseconds(1)), -1);
+	EXPECT_EQ(executive.taskCount(), CyclicExecutive::MAX_TASKS);
+
+	EXPECT_EQ(executive.addInput("nofd", -1, probeTask, &probe), -1);
+	EXPECT_EQ(executive.addInput("null", 0, nullptr, &probe), -1);
+	for (size_t i = 0; i < CyclicExecutive::MAX_INPUTS; i++)
+		EXPECT_EQ(executive.addInput("input", 0, probeTask, &probe), static_cast<int>(i));
+	EXPECT_EQ(executive.addInput("full", 0, probeTask, &probe), -1);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "DrivingCommandPublisher.hpp"
+
+/********************************/
+/* DRIVING COMMAND PUBLISHER    */
+/********************************/
+
+static constexpr int64_t	MS = 1000000;
+
+// Schedule only (no controller): 20 ms refresh, 5 ms gap
+static DrivingCommandPublisher	makePublisher() {
+
+	return (DrivingCommandPublisher(nullptr));
+}
+
+// Nothing is sent before the first setpoint, which goes out at once
+TEST(DrivingCommandPublisherTest, FirstSetpointSentImmediately) {
+
+	DrivingCommandPublisher publisher = makePublisher();
+
+	EXPECT_EQ(publisher.tick(0), PUBLISH_NONE);
+	EXPECT_EQ(publisher.tick(100 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.update(0, 60, 100 * MS), PUBLISH_CHANGE);
+	EXPECT_EQ(publisher.stats().changes, 1u);
+}
+
+// An unchanged setpoint is repeated every period, bounding staleness
+TEST(DrivingCommandPublisherTest, RefreshesAtFixedRate) {
+
+	DrivingCommandPublisher publisher = makePublisher();
+
+	ASSERT_EQ(publisher.update(10, 60, 0), PUBLISH_CHANGE);
+	EXPECT_EQ(publisher.tick(5 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.tick(19 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.tick(20 * MS), PUBLISH_REFRESH);
+	EXPECT_EQ(publisher.tick(25 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.tick(40 * MS), PUBLISH_REFRESH);
+
+	// One frame per period over a second, whatever the tick rate
+	for (int64_t t = 41 * MS; t <= 1040 * MS; t += MS)
+		publisher.tick(t);
+	EXPECT_EQ(publisher.stats().refreshes, 2u + 50u);
+}
+
+// Significant changes respect the minimum gap and are flushed afterwards
+TEST(DrivingCommandPublisherTest, MinimumGapDefersChanges) {
+
+	DrivingCommandPublisher publisher = makePublisher();
+
+	ASSERT_EQ(publisher.update(0, 60, 0), PUBLISH_CHANGE);
+	EXPECT_EQ(publisher.update(50, 60, 1 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.update(100, 80, 2 * MS), PUBLISH_NONE);	// overwrites, not queued
+	EXPECT_EQ(publisher.tick(4 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.tick(5 * MS), PUBLISH_CHANGE);
+	EXPECT_EQ(publisher.tick(6 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.update(0, 60, 20 * MS), PUBLISH_CHANGE);
+
+	EXPECT_EQ(publisher.stats().changes, 3u);
+	EXPECT_EQ(publisher.stats().deferred, 2u);
+}
+
+// A sweep costs at most one frame per gap
+TEST(DrivingCommandPublisherTest, SweepIsRateLimited) {
+
+	DrivingCommandPublisher publisher = makePublisher();
+	int sent = 0;
+
+	// Report every 100 us for 100 ms, every one a significant change
+	for (int i = 0; i < 1000; i++) {
+		int16_t throttle = static_cast<int16_t>((i % 2) ? 100 : -100);
+		if (publisher.update(throttle, 60, i * MS / 10) != PUBLISH_NONE)
+			sent++;
+	}
+	EXPECT_LE(sent, 20);
+	EXPECT_GE(sent, 19);
+}
+
+// Small moves are carried by the next refresh instead of a frame each
+TEST(DrivingCommandPublisherTest, SmallChangesWaitForRefresh) {
+
+	DrivingCommandPublisher publisher = makePublisher();
+
+	ASSERT_EQ(publisher.update(0, 60, 0), PUBLISH_CHANGE);
+	EXPECT_EQ(publisher.update(5, 61, 10 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.tick(20 * MS), PUBLISH_REFRESH);
+
+	// Drift accumulates against the last sent value
+	EXPECT_EQ(publisher.update(9, 61, 30 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.update(15, 61, 31 * MS), PUBLISH_CHANGE);
+}
+
+// A paused publisher sends nothing until the next setpoint
+TEST(DrivingCommandPublisherTest, PauseUntilNextUpdate) {
+
+	DrivingCommandPublisher publisher = makePublisher();
+
+	ASSERT_EQ(publisher.update(50, 60, 0), PUBLISH_CHANGE);
+	publisher.pause();
+	EXPECT_EQ(publisher.tick(100 * MS), PUBLISH_NONE);
+	EXPECT_EQ(publisher.tick(500 * MS), PUBLISH_NONE);
+
+	// Same setpoint after the pause: refreshed at once, the MCU got a brake meanwhile
+	EXPECT_EQ(publisher.update(50, 60, 600 * MS), PUBLISH_REFRESH);
+}
+
+TEST(DrivingCommandPublisherTest, RejectsInvalidConfig) {
+
+	t_publisherConfig config;
+	config.period = std::chrono::nanoseconds(0);
+	EXPECT_THROW(DrivingCommandPublisher(nullptr, config), std::invalid_argument);
+
+	config = t_publisherConfig{};
+	config.minGap = std::chrono::nanoseconds(-1);
+	EXPECT_THROW(DrivingCommandPublisher(nullptr, config), std::invalid_argument);
+}
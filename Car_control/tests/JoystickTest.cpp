@@ -215,6 +215,29 @@ TEST(JoystickTest, InteractiveButtonTest) {
 	}
 }
 
+// Test readReport drains the queue and returns in-range snapshots
+TEST(JoystickTest, ReadReportDrainsQueue) {
+	try {
+		Joystick joystick;
+		t_joystickReport report = {};
+		int ret;
+		int reports = 0;
+
+		// Bounded: a stick moving during the test keeps producing reports
+		while ((ret = joystick.readReport(&report)) == 1 && reports < 1000) {
+			EXPECT_GE(report.steering, 0);
+			EXPECT_LE(report.steering, 180);
+			EXPECT_GE(report.throttle, -100);
+			EXPECT_LE(report.throttle, 100);
+			reports++;
+		}
+		EXPECT_TRUE(ret == 0 || ret == 1) << "controller reported as disconnected";
+		EXPECT_EQ(joystick.waitEvent(0) == 1, joystick.hasPendingEvent());
+	} catch (const std::runtime_error& e) {
+		GTEST_SKIP() << "No joystick available: " << e.what();
+	}
+}
+
 TEST(StableValuesTest, SteeringWithinDeadzoneIsCentered) {
 	int16_t steering = 60;
 	int16_t throttle = 100;
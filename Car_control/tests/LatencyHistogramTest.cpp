@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "LatencyHistogram.hpp"
+#include <thread>
+#include <vector>
+
+/********************************/
+/*   LATENCY HISTOGRAM TESTS    */
+/********************************/
+
+#define US	1000LL
+
+// Buckets tile [0, 2^MAX_BITS) without gap, each within 1/32 of its lowest value
+TEST(LatencyHistogramTest, BucketsAreContiguous) {
+
+	EXPECT_EQ(LatencyHistogram::BUCKETS, 1024u);
+	EXPECT_EQ(LatencyHistogram::bucketLow(0), 0);
+	for (size_t i = 0; i + 1 < LatencyHistogram::BUCKETS; i++) {
+		int64_t	low = LatencyHistogram::bucketLow(i);
+		int64_t	high = LatencyHistogram::bucketHigh(i);
+		ASSERT_EQ(high + 1, LatencyHistogram::bucketLow(i + 1)) << i;
+		ASSERT_LE(high - low, low / LatencyHistogram::HALF_COUNT) << i;
+		ASSERT_EQ(LatencyHistogram::bucketOf(low), i);
+		ASSERT_EQ(LatencyHistogram::bucketOf(high), i);
+	}
+	EXPECT_EQ(LatencyHistogram::bucketHigh(LatencyHistogram::BUCKETS - 1),
+		(1LL << LatencyHistogram::MAX_BITS) - 1);
+}
+
+TEST(LatencyHistogramTest, OutOfRangeValues) {
+
+	EXPECT_EQ(LatencyHistogram::bucketOf(-5), 0u);
+	EXPECT_EQ(LatencyHistogram::bucketOf(63), 63u);
+	EXPECT_EQ(LatencyHistogram::bucketOf(1LL << 40), LatencyHistogram::BUCKETS - 1);
+
+	LatencyHistogram	histogram;
+	t_histogramSummary	summary;
+
+	histogram.record(-100);
+	histogram.record(1LL << 40);
+	histogram.summarize(&summary);
+	EXPECT_EQ(summary.count, 2u);
+	EXPECT_EQ(summary.minNs, 0);
+	EXPECT_EQ(summary.maxNs, 1LL << 40);	// Exact even beyond the buckets
+	EXPECT_EQ(summary.p99Ns, 1LL << 40);
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+
+	LatencyHistogram	histogram;
+	t_histogramSummary	summary;
+
+	histogram.summarize(&summary);
+	EXPECT_EQ(summary.count, 0u);
+	EXPECT_EQ(summary.maxNs, 0);
+	EXPECT_EQ(histogram.percentile(50), 0);
+
+	for (int64_t i = 1; i <= 1000; i++)
+		histogram.record(i * US);
+	histogram.summarize(&summary);
+
+	EXPECT_EQ(summary.count, 1000u);
+	EXPECT_EQ(histogram.count(), 1000u);
+	EXPECT_EQ(summary.minNs, 1 * US);
+	EXPECT_EQ(summary.maxNs, 1000 * US);
+	EXPECT_EQ(summary.meanNs, 500500);
+
+	// Never below the exact value, at most one bucket above it
+	const int64_t	exact[4] = {500 * US, 900 * US, 990 * US, 999 * US};
+	const int64_t	found[4] = {summary.p50Ns, summary.p90Ns, summary.p99Ns, summary.p999Ns};
+	for (int i = 0; i < 4; i++) {
+		EXPECT_GE(found[i], exact[i]);
+		EXPECT_LE(found[i], exact[i] + exact[i] / 32);
+	}
+	EXPECT_EQ(histogram.percentile(99), summary.p99Ns);
+	EXPECT_EQ(histogram.percentile(100), 1000 * US);
+	EXPECT_EQ(histogram.percentile(0), 1 * US);
+
+	histogram.reset();
+	histogram.summarize(&summary);
+	EXPECT_EQ(summary.count, 0u);
+	EXPECT_EQ(histogram.count(), 0u);
+}
+
+// Writers on several threads lose no record
+TEST(LatencyHistogramTest, ConcurrentRecords) {
+
+	LatencyHistogram			histogram;
+	std::vector<std::thread>	writers;
+	t_histogramSummary			summary;
+
+	for (int t = 0; t < 4; t++) {
+		writers.emplace_back([&histogram, t]() {
+			for (int64_t i = 0; i < 10000; i++)
+				histogram.record((t + 1) * 100 * US + i);
+		});
+	}
+	for (std::thread &writer : writers)
+		writer.join();
+
+	histogram.summarize(&summary);
+	EXPECT_EQ(summary.count, 40000u);
+	EXPECT_EQ(histogram.count(), 40000u);
+	EXPECT_EQ(summary.minNs, 100 * US);
+	EXPECT_EQ(summary.maxNs, 400 * US + 9999);
+}
@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include <sys/resource.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <thread>
 #include <socketCAN.h>
 #include "CANController.hpp"
 
@@ -407,6 +412,247 @@ TEST_F(socketCANTest, DirectReceiveTest) {
 	can_close(receiver_socket);
 }
 
+// Direct test of can_receive_timeout function
+TEST_F(socketCANTest, ReceiveTimeoutTest) {
+
+	int sender_socket = socketCan_init(validInterface);
+	int receiver_socket = socketCan_init(validInterface);
+	ASSERT_GE(sender_socket, 0);
+	ASSERT_GE(receiver_socket, 0);
+
+	struct can_frame received_frame;
+
+	// Test 1: Idle bus times out
+	{
+		auto start = std::chrono::steady_clock::now();
+		EXPECT_EQ(can_receive_timeout(receiver_socket, &received_frame, 20, -1), CAN_RX_TIMEOUT);
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		EXPECT_GE(elapsed, std::chrono::milliseconds(15));
+	}
+
+	// Test 2: Frame wakes the receiver up
+	{
+		uint8_t expected_bytes[2] = {0x12, 0x34};
+		ASSERT_EQ(can_send_frame(sender_socket, 0x321, (int8_t*)expected_bytes, 2), 0);
+		ASSERT_EQ(can_receive_timeout(receiver_socket, &received_frame, 1000, -1), 0);
+		EXPECT_EQ(received_frame.can_id, 0x321u);
+		EXPECT_EQ(received_frame.can_dlc, 2);
+		EXPECT_EQ(received_frame.data[0], expected_bytes[0]);
+		EXPECT_EQ(received_frame.data[1], expected_bytes[1]);
+	}
+
+	// Test 3: Wakeup descriptor interrupts the wait
+	{
+		int wake = eventfd(0, EFD_NONBLOCK);
+		ASSERT_GE(wake, 0);
+		uint64_t one = 1;
+		ASSERT_EQ(write(wake, &one, sizeof(one)), (ssize_t)sizeof(one));
+		EXPECT_EQ(can_receive_timeout(receiver_socket, &received_frame, 1000, wake), CAN_RX_WAKEUP);
+		close(wake);
+	}
+
+	can_close(sender_socket);
+	can_close(receiver_socket);
+}
+
+// Socket errors are consumed and reported instead of spinning the caller
+// A UDP socket is used to get a pending error (ECONNREFUSED) without a CAN bus
+TEST_F(socketCANTest, ReceiveSocketErrorBacksOff) {
+
+	int s = socket(AF_INET, SOCK_DGRAM, 0);
+	ASSERT_GE(s, 0);
+
+	struct sockaddr_in	addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(9);
+	ASSERT_EQ(connect(s, (struct sockaddr *)&addr, sizeof(addr)), 0);
+
+	struct can_frame	frame;
+	t_canRxBatch		batch;
+	can_rx_batch_init(&batch);
+
+	// Test 1: Pending error is reported after backing off for the timeout
+	{
+		ASSERT_EQ(send(s, "x", 1, 0), 1);
+		auto start = std::chrono::steady_clock::now();
+		errno = 0;
+		EXPECT_EQ(can_receive_timeout(s, &frame, 50, -1), -1);
+		EXPECT_EQ(errno, ECONNREFUSED);
+		EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(40));
+	}
+
+	// Test 2: Error was consumed, the next wait is a plain timeout
+	EXPECT_EQ(can_receive_batch(s, &batch, 20, -1), 0);
+	EXPECT_EQ(can_receive_timeout(s, &frame, 20, -1), CAN_RX_TIMEOUT);
+
+	// Test 3: Wakeup descriptor cuts the back off short
+	{
+		int wake = eventfd(0, EFD_NONBLOCK);
+		ASSERT_GE(wake, 0);
+		ASSERT_EQ(send(s, "x", 1, 0), 1);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+		std::thread waker([&]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			uint64_t one = 1;
+			EXPECT_EQ(write(wake, &one, sizeof(one)), (ssize_t)sizeof(one));
+		});
+		auto start = std::chrono::steady_clock::now();
+		EXPECT_EQ(can_receive_batch(s, &batch, 5000, wake), CAN_RX_WAKEUP);
+		EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+		waker.join();
+
+		// The descriptor stays signaled, every receive reports the same code
+		EXPECT_EQ(can_receive_timeout(s, &frame, 5000, wake), CAN_RX_WAKEUP);
+		close(wake);
+	}
+
+	close(s);
+}
+
+// Extra sockets on an already validated interface
+TEST_F(socketCANTest, SocketCanOpenTest) {
+
+	// Test 1: Valid interface, no second MTU check needed
+	{
+		int s = socketCan_open(validInterface);
+		EXPECT_GE(s, 0);
+		can_close(s);
+	}
+
+	// Test 2: Invalid and NULL interfaces are still rejected
+	EXPECT_EQ(socketCan_open(invalidInterface), -1);
+	EXPECT_EQ(socketCan_open(NULL), -1);
+}
+
+// Direct test of can_receive_batch function
+TEST_F(socketCANTest, ReceiveBatchTest) {
+
+	int sender_socket = socketCan_init(validInterface);
+	int receiver_socket = socketCan_init(validInterface);
+	ASSERT_GE(sender_socket, 0);
+	ASSERT_GE(receiver_socket, 0);
+
+	t_canRxBatch batch;
+	can_rx_batch_init(&batch);
+
+	// Test 1: Idle bus times out with no frames
+	EXPECT_EQ(can_receive_batch(receiver_socket, &batch, 10, -1), 0);
+
+	// Test 2: Burst is drained in a single call, in order
+	{
+		const int burst = 20;
+		for (int i = 0; i < burst; i++) {
+			int8_t data[1] = {static_cast<int8_t>(i)};
+			ASSERT_EQ(can_send_frame(sender_socket, 0x300, data, 1), 0);
+		}
+		usleep(5000);
+
+		int count = can_receive_batch(receiver_socket, &batch, 1000, -1);
+		ASSERT_EQ(count, burst);
+		for (int i = 0; i < count; i++) {
+			EXPECT_EQ(batch.frames[i].can_id, 0x300u);
+			EXPECT_EQ(batch.frames[i].data[0], i);
+		}
+		EXPECT_EQ(batch.drops, 0u);
+	}
+
+	// Test 3: Wakeup descriptor interrupts the wait
+	{
+		int wake = eventfd(0, EFD_NONBLOCK);
+		ASSERT_GE(wake, 0);
+		uint64_t one = 1;
+		ASSERT_EQ(write(wake, &one, sizeof(one)), (ssize_t)sizeof(one));
+		EXPECT_EQ(can_receive_batch(receiver_socket, &batch, 1000, wake), CAN_RX_WAKEUP);
+		close(wake);
+	}
+
+	can_close(sender_socket);
+	can_close(receiver_socket);
+}
+
+// Kernel drops are reported through SO_RXQ_OVFL
+TEST_F(socketCANTest, ReceiveBatchReportsDrops) {
+
+	int sender_socket = socketCan_init(validInterface);
+	int receiver_socket = socketCan_init(validInterface);
+	ASSERT_GE(sender_socket, 0);
+	ASSERT_GE(receiver_socket, 0);
+
+	// Shrink the receive buffer so a burst overflows it
+	int rcvbuf = 0;
+	ASSERT_EQ(setsockopt(receiver_socket, SOL_SOCKET, SO_RCVBUF,
+		&rcvbuf, sizeof(rcvbuf)), 0);
+
+	int8_t data[8] = {0};
+	for (int i = 0; i < 500; i++)
+		can_send_frame(sender_socket, 0x301, data, 8);
+	usleep(5000);
+
+	t_canRxBatch batch;
+	can_rx_batch_init(&batch);
+	ASSERT_GT(can_receive_batch(receiver_socket, &batch, 1000, -1), 0);
+	EXPECT_GT(batch.drops, 0u);
+
+	can_close(sender_socket);
+	can_close(receiver_socket);
+}
+
+// Kernel-side filtering with can_set_filters
+TEST_F(socketCANTest, SetFiltersTest) {
+
+	int sender_socket = socketCan_init(validInterface);
+	int receiver_socket = socketCan_init(validInterface);
+	ASSERT_GE(sender_socket, 0);
+	ASSERT_GE(receiver_socket, 0);
+
+	// Test 1: Only subscribed IDs are delivered
+	{
+		const uint16_t ids[2] = {0x200, 0x201};
+		ASSERT_EQ(can_set_filters(receiver_socket, ids, 2), 0);
+
+		int8_t data[1] = {1};
+		can_send_frame(sender_socket, 0x100, data, 1);
+		can_send_frame(sender_socket, 0x200, data, 1);
+		can_send_frame(sender_socket, 0x300, data, 1);
+		can_send_frame(sender_socket, 0x201, data, 1);
+		usleep(5000);
+
+		t_canRxBatch batch;
+		can_rx_batch_init(&batch);
+		ASSERT_EQ(can_receive_batch(receiver_socket, &batch, 1000, -1), 2);
+		EXPECT_EQ(batch.frames[0].can_id, 0x200u);
+		EXPECT_EQ(batch.frames[1].can_id, 0x201u);
+	}
+
+	// Test 2: Empty list blocks all reception
+	{
+		ASSERT_EQ(can_set_filters(receiver_socket, nullptr, 0), 0);
+
+		int8_t data[1] = {1};
+		can_send_frame(sender_socket, 0x200, data, 1);
+		usleep(5000);
+
+		struct can_frame frame;
+		EXPECT_EQ(can_try_receive(receiver_socket, &frame), -1);
+	}
+
+	// Test 3: Invalid lists are rejected
+	{
+		const uint16_t bad_id[1] = {0x800};
+		EXPECT_EQ(can_set_filters(receiver_socket, bad_id, 1), -1);
+		EXPECT_EQ(can_set_filters(receiver_socket, nullptr, 1), -1);
+
+		uint16_t too_many[CAN_MAX_FILTERS + 1] = {0};
+		EXPECT_EQ(can_set_filters(receiver_socket, too_many, CAN_MAX_FILTERS + 1), -1);
+	}
+
+	can_close(sender_socket);
+	can_close(receiver_socket);
+}
+
 // Test canfd_try_receive function
 TEST_F(socketCANTest, DirectReceiveTestFD) {
 
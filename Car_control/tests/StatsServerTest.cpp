@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "StatsServer.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/********************************/
+/*      STATS SERVER TESTS      */
+/********************************/
+
+// Sends one command like tools/carstats does, returns the whole response
+static std::string	query(const char *path, const std::string &command) {
+
+	struct sockaddr_un	addr = {};
+	int					fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	std::string			response;
+	char				buf[1024];
+	ssize_t				n;
+
+	addr.sun_family = AF_UNIX;
+	std::strcpy(addr.sun_path, path);
+	if (fd < 0 || connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+		if (fd >= 0)
+			close(fd);
+		return ("connect failed");
+	}
+	if (write(fd, command.data(), command.size()) < 0)
+		response = "write failed";
+	while ((n = read(fd, buf, sizeof(buf))) > 0)
+		response.append(buf, static_cast<size_t>(n));
+	close(fd);
+	return (response);
+}
+
+TEST(StatsServerTest, Registry) {
+
+	LatencyHistogram	a;
+	LatencyHistogram	b;
+	std::string			out;
+
+	EXPECT_EQ(statsRegister("test.a", &a), 0);
+	EXPECT_EQ(statsRegister("test.a", &b), -1);		// Name taken
+	EXPECT_EQ(statsRegister("with space", &b), -1);
+	EXPECT_EQ(statsRegister("", &b), -1);
+	EXPECT_EQ(statsRegister(std::string(STATS_NAME_SIZE, 'x').c_str(), &b), -1);
+	EXPECT_EQ(statsRegister("test.b", nullptr), -1);
+	{
+		StatsRegistration	scoped("other.b", &b);
+		ASSERT_EQ(statsCommand("list", out), 0);
+		EXPECT_EQ(out, "test.a\nother.b\n");
+	}
+	ASSERT_EQ(statsCommand("list", out), 0);
+	EXPECT_EQ(out, "test.a\n");
+
+	statsUnregister(&a);
+	ASSERT_EQ(statsCommand("list", out), 0);
+	EXPECT_EQ(out, "");
+}
+
+TEST(StatsServerTest, Commands) {
+
+	LatencyHistogram	a;
+	LatencyHistogram	b;
+	std::string			out;
+
+	a.record(1500);
+	a.record(2500);
+	b.record(70);
+	StatsRegistration	aStats("can.tx.0x101", &a);
+	StatsRegistration	bStats("queue.speed.dwell", &b);
+
+	// Header, then one line per match
+	ASSERT_EQ(statsCommand("show can.", out), 0);
+	EXPECT_EQ(out.find("name (us)"), 0u);
+	EXPECT_NE(out.find("can.tx.0x101"), std::string::npos);
+	EXPECT_NE(out.find("2.5"), std::string::npos);
+	EXPECT_EQ(out.find("queue.speed.dwell"), std::string::npos);
+	ASSERT_EQ(statsCommand("show", out), 0);
+	EXPECT_NE(out.find("queue.speed.dwell"), std::string::npos);
+
+	ASSERT_EQ(statsCommand("dump queue.speed.dwell", out), 0);
+	EXPECT_EQ(out, "70 71 1\n");
+	EXPECT_EQ(statsCommand("dump nothing", out), -1);
+	EXPECT_EQ(statsCommand("dump", out), -1);
+
+	EXPECT_EQ(statsCommand("help", out), 0);
+	EXPECT_NE(out.find("show [PREFIX]"), std::string::npos);
+	EXPECT_EQ(statsCommand("reboot", out), -1);
+	EXPECT_NE(out.find("unknown command 'reboot'"), std::string::npos);
+}
+
+// A client queries the running server, the socket file goes away with it
+TEST(StatsServerTest, ServesUnixSocket) {
+
+	char				path[] = "/tmp/statsTestXXXXXX";
+	int					fd = mkstemp(path);
+	LatencyHistogram	histogram;
+	struct stat			st;
+
+	ASSERT_GE(fd, 0);
+	close(fd);	// Stale file, replaced by the socket
+
+	histogram.record(1000);
+	ASSERT_EQ(statsStart(path), 0);
+	EXPECT_EQ(statsStart(path), -1);	// Already running
+	EXPECT_EQ(statsRegister("control.test", &histogram), 0);
+
+	EXPECT_EQ(query(path, "list\n"), "control.test\n");
+	EXPECT_NE(query(path, "show control\r\n").find("control.test"), std::string::npos);
+	EXPECT_EQ(query(path, "dump control.test"), "992 1007 1\n");	// No newline, answered after the read timeout
+	EXPECT_EQ(query(path, "\n"), "no command, try help\n");
+
+	statsStop();
+	EXPECT_NE(stat(path, &st), 0);
+	EXPECT_EQ(query(path, "list\n"), "connect failed");
+
+	// Stopping clears the registry
+	std::string	out;
+	statsCommand("list", out);
+	EXPECT_EQ(out, "");
+	EXPECT_EQ(statsStart("/nonexistent/dir/stats.sock"), -1);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "Trace.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/********************************/
+/*         TRACE TESTS          */
+/********************************/
+
+typedef struct s_row {
+	int			thread;
+	std::string	stage;
+	uint32_t	canId;
+	uint32_t	chain;
+	int64_t		timestampNs;
+} t_row;
+
+// Dumps every buffer and keeps the rows of one CAN ID (buffers are process wide)
+static std::vector<t_row>	dumpRows(uint32_t canId) {
+
+	char				path[] = "/tmp/traceTestXXXXXX";
+	int					fd = mkstemp(path);
+	std::vector<t_row>	rows;
+	std::string			line;
+
+	EXPECT_GE(fd, 0);
+	close(fd);
+	EXPECT_GE(traceDump(path), 0);
+
+	std::ifstream	in(path);
+	std::getline(in, line);
+	EXPECT_EQ(line, "thread,stage,canId,chain,timestampNs");
+	while (std::getline(in, line)) {
+		std::stringstream	ss(line);
+		std::string			field[5];
+		for (std::string &f : field)
+			std::getline(ss, f, ',');
+		t_row	row = {std::stoi(field[0]), field[1],
+			static_cast<uint32_t>(std::stoul(field[2], nullptr, 16)),
+			static_cast<uint32_t>(std::stoul(field[3])), std::stoll(field[4])};
+		if (row.canId == canId)
+			rows.push_back(row);
+	}
+	unlink(path);
+	return (rows);
+}
+
+// Stages recorded after traceBegin() share its chain, the next one opens a new chain
+TEST(TraceTest, ChainsFollowTraceBegin) {
+
+	std::thread	worker([]() {
+		traceBegin();
+		traceRecord(TRACE_EVDEV_EVENT, 0x7a1, 100);
+		traceRecord(TRACE_DECODE, 0x7a1, 200);
+		traceRecord(TRACE_CAN_WRITE, 0x7a1, 300);
+		traceBegin();
+		traceRecord(TRACE_CAN_WRITE, 0x7a1, 400);
+	});
+	worker.join();
+
+	std::vector<t_row>	rows = dumpRows(0x7a1);
+	ASSERT_EQ(rows.size(), 4u);
+	EXPECT_EQ(rows[0].stage, "evdev");
+	EXPECT_EQ(rows[1].stage, "decode");
+	EXPECT_EQ(rows[2].stage, "can_write");
+	EXPECT_EQ(rows[3].stage, "can_write");
+	EXPECT_NE(rows[0].chain, 0u);
+	EXPECT_EQ(rows[1].chain, rows[0].chain);
+	EXPECT_EQ(rows[2].chain, rows[0].chain);
+	EXPECT_NE(rows[3].chain, rows[0].chain);
+	EXPECT_EQ(rows[0].timestampNs, 100);
+	EXPECT_EQ(rows[3].timestampNs, 400);
+}
+
+// Each recording thread writes into its own buffer
+TEST(TraceTest, ThreadsUseSeparateBuffers) {
+
+	std::thread	a([]() { traceRecord(TRACE_CAN_WRITE, 0x7a2, 1); });
+	a.join();
+	std::thread	b([]() { traceRecord(TRACE_TX_CONFIRM, 0x7a2, 2); });
+	b.join();
+
+	std::vector<t_row>	rows = dumpRows(0x7a2);
+	ASSERT_EQ(rows.size(), 2u);
+	EXPECT_NE(rows[0].thread, rows[1].thread);
+	EXPECT_EQ(rows[0].chain, 0u);
+	EXPECT_EQ(rows[1].stage, "tx_confirm");
+}
+
+// A full buffer keeps the newest TRACE_BUFFER_SIZE records, oldest first
+TEST(TraceTest, WrapsOverOldest) {
+
+	std::thread	worker([]() {
+		for (int64_t i = 0; i < TRACE_BUFFER_SIZE + 10; i++)
+			traceRecord(TRACE_DECODE, 0x7a3, i);
+	});
+	worker.join();
+
+	std::vector<t_row>	rows = dumpRows(0x7a3);
+	ASSERT_EQ(rows.size(), static_cast<size_t>(TRACE_BUFFER_SIZE));
+	EXPECT_EQ(rows.front().timestampNs, 10);
+	EXPECT_EQ(rows.back().timestampNs, TRACE_BUFFER_SIZE + 9);
+}
+
+TEST(TraceTest, StageNames) {
+
+	EXPECT_STREQ(traceStageName(TRACE_EVDEV_EVENT), "evdev");
+	EXPECT_STREQ(traceStageName(TRACE_TX_CONFIRM), "tx_confirm");
+	EXPECT_STREQ(traceStageName(TRACE_STAGE_COUNT), "unknown");
+	EXPECT_EQ(traceDump("/nonexistent/dir/trace.csv"), -1);
+}
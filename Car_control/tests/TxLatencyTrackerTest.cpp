@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "TxLatencyTracker.hpp"
+#include <sstream>
+#include <thread>
+
+/********************************/
+/*    TX LATENCY TRACKER TESTS  */
+/********************************/
+
+#define MS	1000000LL
+
+// Each echo is matched with the oldest unconfirmed send of its ID
+TEST(TxLatencyTrackerTest, MatchesInOrder) {
+
+	TxLatencyTracker	tracker;
+	t_txLatencyStats	stats;
+
+	EXPECT_FALSE(tracker.stats(0x101, &stats));
+	tracker.sent(0x101, 1000 * MS);
+	tracker.sent(0x101, 1000 * MS + 10000);
+	tracker.sent(0x100, 1000 * MS + 20000);
+
+	EXPECT_TRUE(tracker.confirm(0x101, 1000 * MS + 50000));	// 50 us
+	EXPECT_TRUE(tracker.confirm(0x100, 1000 * MS + 25000));	// 5 us
+	EXPECT_TRUE(tracker.confirm(0x101, 1000 * MS + 90000));	// 80 us
+	EXPECT_FALSE(tracker.confirm(0x101, 1000 * MS + 95000));	// Nothing left
+
+	ASSERT_TRUE(tracker.stats(0x101, &stats));
+	EXPECT_EQ(stats.sent, 2u);
+	EXPECT_EQ(stats.confirmed, 2u);
+	EXPECT_EQ(stats.lost, 0u);
+	EXPECT_EQ(stats.minNs, 50000);
+	EXPECT_EQ(stats.maxNs, 80000);
+	EXPECT_EQ(stats.meanNs, 65000);
+	EXPECT_EQ(stats.p50Ns, 50175);		// [49152, 50175] ns bucket
+	EXPECT_EQ(stats.p99Ns, 80000);		// Bucket bound clamped to max
+
+	ASSERT_TRUE(tracker.stats(0x100, &stats));
+	EXPECT_EQ(stats.confirmed, 1u);
+	EXPECT_EQ(stats.minNs, 5000);
+	EXPECT_EQ(tracker.unmatched(), 1u);
+
+	uint16_t	ids[TX_TRACKED_IDS];
+	ASSERT_EQ(tracker.ids(ids, TX_TRACKED_IDS), 2u);
+	EXPECT_EQ(ids[0], 0x101);
+	EXPECT_EQ(ids[1], 0x100);
+}
+
+// Failed writes produce no echo and are skipped
+TEST(TxLatencyTrackerTest, SkipsFailedWrites) {
+
+	TxLatencyTracker	tracker;
+	t_txLatencyStats	stats;
+
+	uint64_t	ticket = tracker.sent(0x101, 10 * MS);
+	tracker.failed(0x101, ticket);
+	tracker.sent(0x101, 20 * MS);
+
+	EXPECT_TRUE(tracker.confirm(0x101, 20 * MS + 1000));
+	ASSERT_TRUE(tracker.stats(0x101, &stats));
+	EXPECT_EQ(stats.sent, 1u);
+	EXPECT_EQ(stats.confirmed, 1u);
+	EXPECT_EQ(stats.maxNs, 1000);
+}
+
+// An echo never seen does not shift every later match
+TEST(TxLatencyTrackerTest, DetectsLostEcho) {
+
+	TxLatencyTracker	tracker;
+	t_txLatencyStats	stats;
+	int64_t				stale = std::chrono::nanoseconds(TX_ECHO_STALE).count();
+
+	tracker.sent(0x101, 0 * MS + 1);
+	tracker.sent(0x101, stale + 10 * MS);
+
+	// Echo of the second send only
+	EXPECT_TRUE(tracker.confirm(0x101, stale + 10 * MS + 2000));
+	ASSERT_TRUE(tracker.stats(0x101, &stats));
+	EXPECT_EQ(stats.lost, 1u);
+	EXPECT_EQ(stats.confirmed, 1u);
+	EXPECT_EQ(stats.maxNs, 2000);
+}
+
+// Echoes older than the pending send, or of unknown IDs, are not matches
+TEST(TxLatencyTrackerTest, RejectsForeignEchoes) {
+
+	TxLatencyTracker	tracker;
+	t_txLatencyStats	stats;
+
+	tracker.sent(0x101, 100 * MS);
+	EXPECT_FALSE(tracker.confirm(0x101, 99 * MS));
+	EXPECT_FALSE(tracker.confirm(0x200, 101 * MS));
+	EXPECT_TRUE(tracker.confirm(0x101, 101 * MS));
+	EXPECT_EQ(tracker.unmatched(), 2u);
+
+	// Lookups of unknown IDs never claim an entry
+	EXPECT_FALSE(tracker.stats(0x200, &stats));
+}
+
+// Unconfirmed sends beyond TX_PENDING_PER_ID are counted lost
+TEST(TxLatencyTrackerTest, OverflowCountsLost) {
+
+	TxLatencyTracker	tracker;
+	t_txLatencyStats	stats;
+
+	for (int i = 0; i < TX_PENDING_PER_ID + 4; i++)
+		tracker.sent(0x101, (i + 1) * MS);
+
+	EXPECT_TRUE(tracker.confirm(0x101, 5 * MS + 500));
+	ASSERT_TRUE(tracker.stats(0x101, &stats));
+	EXPECT_EQ(stats.lost, 4u);
+	EXPECT_EQ(stats.maxNs, 500);
+}
+
+TEST(TxLatencyTrackerTest, TableFull) {
+
+	TxLatencyTracker	tracker;
+
+	for (uint16_t id = 0; id < TX_TRACKED_IDS; id++)
+		EXPECT_NE(tracker.sent(id, MS), TX_UNTRACKED);
+	EXPECT_EQ(tracker.sent(0x7FF, MS), TX_UNTRACKED);
+	tracker.failed(0x7FF, TX_UNTRACKED);
+	EXPECT_FALSE(tracker.confirm(0x7FF, 2 * MS));
+}
+
+// Senders on several threads, confirmations on one
+TEST(TxLatencyTrackerTest, ConcurrentSenders) {
+
+	TxLatencyTracker	tracker;
+	t_txLatencyStats	stats;
+
+	std::thread	a([&tracker]() { tracker.sent(0x100, MS); });
+	std::thread	b([&tracker]() { tracker.sent(0x101, MS); });
+	a.join();
+	b.join();
+
+	EXPECT_TRUE(tracker.confirm(0x100, 2 * MS));
+	EXPECT_TRUE(tracker.confirm(0x101, 2 * MS));
+	ASSERT_TRUE(tracker.stats(0x100, &stats));
+	EXPECT_EQ(stats.confirmed, 1u);
+
+	std::ostringstream	out;
+	tracker.report(out, "[CAN TX] ");
+	EXPECT_NE(out.str().find("[CAN TX] 0x100: sent 1, confirmed 1, lost 0"), std::string::npos);
+}
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+#include "carControl.h"
+#include <thread>
+#include <chrono>
+
+class canReceiverTest : public ::testing::Test {
+
+protected:
+	const std::string validInterface = "vcan0";
+
+	void SetUp() override {
+		// Setup vcan0
+		system("sudo ip link add dev vcan0 type vcan");
+		system("sudo ip link set vcan0 mtu 72");
+		system("sudo ip link set up vcan0");
+		g_running.store(true);
+		g_stm32Lost.store(false);
+	}
+
+	void TearDown() override {
+		// Cleanup: remove virtual CAN interface
+		system("sudo ip link delete vcan0 2>/dev/null");
+	}
+};
+
+// Frames are decoded and pushed to the matching queue
+TEST_F(canReceiverTest, DispatchesSpeedAndBattery) {
+
+	CANController sender(validInterface);
+	CANController can(validInterface);
+
+	t_CANReceiver receiver;
+	ASSERT_EQ(initCANReceiver(&receiver, &can), 1);
+	receiver.queueSamples = true;
+	std::thread rx(canReceiverThread, &receiver);
+
+	const int8_t speed[2] = {0x01, 0x02};
+	const int8_t battery[3] = {0x00, 0x50, 0x0C};
+	sender.sendFrame(CANRECEIVERID::SPEEDRPMSTM32, speed, 2);
+	sender.sendFrame(CANRECEIVERID::BATTERYSTM32, battery, 3);
+
+	t_speedData		speedData;
+	t_batteryData	batteryData;
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+	while (receiver.batteryQueue.empty() && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	can.wakeup();
+	rx.join();
+
+	ASSERT_TRUE(getSpeedData(&receiver, &speedData));
+	EXPECT_EQ(speedData.rpm, 0x0102);
+	ASSERT_TRUE(getBatteryData(&receiver, &batteryData));
+	EXPECT_EQ(batteryData.percentage, 0x50);
+	EXPECT_EQ(batteryData.voltage, 0x0C);
+
+	// Kernel receive times, in order and not in the future
+	int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	EXPECT_GT(speedData.timestampNs, 0);
+	EXPECT_LE(speedData.timestampNs, batteryData.timestampNs);
+	EXPECT_LE(batteryData.timestampNs, now);
+
+	// Mailboxes hold the same samples, stamped at reception
+	t_speedSample	speedSample;
+	uint64_t		lastSequence = 0;
+	ASSERT_TRUE(getLatestSpeed(&receiver, &speedSample, &lastSequence));
+	EXPECT_EQ(speedSample.value.rpm, 0x0102);
+	EXPECT_EQ(speedSample.sequence, 1u);
+	EXPECT_GT(speedSample.timestampNs, 0);
+}
+
+// Without a queue consumer only the mailboxes are fed
+TEST_F(canReceiverTest, QueuesOnlyFedOnRequest) {
+
+	CANController sender(validInterface);
+	CANController can(validInterface);
+
+	t_CANReceiver receiver;
+	ASSERT_EQ(initCANReceiver(&receiver, &can), 1);
+	std::thread rx(canReceiverThread, &receiver);
+
+	const int8_t speed[2] = {0x01, 0x02};
+	for (size_t i = 0; i < 2 * receiver.speedQueue.capacity(); i++)
+		sender.sendFrame(CANRECEIVERID::SPEEDRPMSTM32, speed, 2);
+
+	t_speedSample	speedSample;
+	uint64_t		lastSequence = 0;
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+	while (receiver.speedMailbox.sequence() < 2 * receiver.speedQueue.capacity()
+		&& std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	can.wakeup();
+	rx.join();
+
+	ASSERT_TRUE(getLatestSpeed(&receiver, &speedSample, &lastSequence));
+	EXPECT_EQ(speedSample.sequence, 2 * receiver.speedQueue.capacity());
+	EXPECT_TRUE(receiver.speedQueue.empty());
+	EXPECT_EQ(receiver.speedQueue.dropped(), 0u);
+}
+
+// Kernel-side drops on the RX socket are published in rxDrops
+TEST_F(canReceiverTest, PublishesKernelDrops) {
+
+	CANController sender(validInterface);
+	CANController can(validInterface);
+
+	// Shrink the receive buffer so a burst overflows it before the thread runs
+	int rcvbuf = 0;
+	ASSERT_EQ(setsockopt(can.getRxSocket(), SOL_SOCKET, SO_RCVBUF,
+		&rcvbuf, sizeof(rcvbuf)), 0);
+
+	const int8_t speed[2] = {0x00, 0x10};
+	for (int i = 0; i < 500; i++) {
+		try {
+			sender.sendFrame(CANRECEIVERID::SPEEDRPMSTM32, speed, 2);
+		} catch (const CANController::CANException&) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+	t_CANReceiver receiver;
+	receiver.can = &can;
+	ASSERT_EQ(registerReceiverHandlers(&receiver), 0);
+	EXPECT_EQ(receiver.rxDrops.load(), 0u);
+	std::thread rx(canReceiverThread, &receiver);
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+	while (receiver.rxDrops.load() == 0 && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	can.wakeup();
+	rx.join();
+
+	EXPECT_GT(receiver.rxDrops.load(), 0u);
+}
+
+// A silent STM32 is braked once and holds the driving commands until it is back
+TEST_F(canReceiverTest, MonitorHoldsCommandsWhileStm32Lost) {
+
+	CANController sender(validInterface);
+	CANController can(validInterface);
+
+	t_CANReceiver receiver;
+	ASSERT_EQ(initCANReceiver(&receiver, &can), 1);
+	std::thread rx(canReceiverThread, &receiver);
+	std::thread monitor(monitoringThread, &receiver);
+
+	const int8_t speed[2] = {0x00, 0x10};
+	auto waitLost = [](bool lost) {
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+		while (g_stm32Lost.load() != lost && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return (g_stm32Lost.load() == lost);
+	};
+
+	// Test 1: Speed data keeps the link up
+	for (int i = 0; i < 5; i++) {
+		sender.sendFrame(CANRECEIVERID::SPEEDRPMSTM32, speed, 2);
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	EXPECT_FALSE(g_stm32Lost.load());
+
+	// Test 2: Silence holds the commands and sends one emergency brake
+	{
+		EXPECT_TRUE(waitLost(true));
+		struct can_frame frame;
+		bool braked = false;
+		while (!braked && sender.receiveFrameBlocking(&frame, 1000) == 0)
+			braked = (frame.can_id == CANSENDID::EMERGENCY_BRAKE && frame.data[0] == 0x0F);
+		EXPECT_TRUE(braked);
+	}
+
+	// Test 3: Speed data releases them again
+	sender.sendFrame(CANRECEIVERID::SPEEDRPMSTM32, speed, 2);
+	EXPECT_TRUE(waitLost(false));
+
+	g_running.store(false);
+	can.wakeup();
+	rx.join();
+	monitor.join();
+}
+
+// Kernel timestamps reach the samples on the steady clock, spacing preserved
+TEST(canReceiverTimestampTest, KernelTimestampsReachSamples) {
+
+	t_CANReceiver	receiver;
+	t_canRxBatch	batch;
+	struct timespec	realtime;
+
+	receiver.can = nullptr;
+	receiver.queueSamples = true;
+	ASSERT_EQ(registerReceiverHandlers(&receiver), 0);
+	can_rx_batch_init(&batch);
+
+	clock_gettime(CLOCK_REALTIME, &realtime);
+	int64_t	realNow = static_cast<int64_t>(realtime.tv_sec) * 1000000000LL + realtime.tv_nsec;
+	int64_t	steadyNow = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	for (int i = 0; i < 4; i++) {
+		batch.frames[i].can_id = CANMSG::SPEED::ID;
+		batch.frames[i].can_dlc = CANMSG::SPEED::DLC;
+		batch.frames[i].data[0] = static_cast<uint8_t>(i);
+	}
+	batch.timestampsNs[0] = realNow - 5000000;		// 5 ms before
+	batch.timestampsNs[1] = realNow - 2000000;		// 3 ms later
+	batch.timestampsNs[2] = 0;						// Socket without timestamps
+	batch.timestampsNs[3] = realNow + 60000000000LL;	// Wall clock stepped back since
+
+	dispatchRxBatch(&receiver, &batch, 4);
+
+	t_speedData	samples[4];
+	for (t_speedData &sample : samples)
+		ASSERT_TRUE(getSpeedData(&receiver, &sample));
+
+	EXPECT_EQ(samples[1].timestampNs - samples[0].timestampNs, 3000000);
+	EXPECT_NEAR(static_cast<double>(samples[0].timestampNs),
+		static_cast<double>(steadyNow - 5000000), 2000000.0);
+	EXPECT_GE(samples[2].timestampNs, steadyNow);
+	EXPECT_EQ(samples[3].timestampNs, samples[2].timestampNs);
+
+	// The mailbox carries the newest frame's time too
+	t_speedSample	latest;
+	uint64_t		sequence = 0;
+	ASSERT_TRUE(getLatestSpeed(&receiver, &latest, &sequence));
+	EXPECT_EQ(latest.timestampNs, samples[3].timestampNs);
+
+	// Three gaps between four frames, every pop and mailbox read is timed
+	EXPECT_EQ(receiver.speedInterArrival.count(), 3u);
+	EXPECT_EQ(receiver.speedInterArrival.percentile(0), 0);
+	EXPECT_EQ(receiver.speedDwell.count(), 4u);
+	EXPECT_EQ(receiver.speedAge.count(), 1u);
+	EXPECT_EQ(receiver.batteryDwell.count(), 0u);
+
+	// No CAN controller, no TX histograms
+	EXPECT_EQ(registerReceiverStats(&receiver), 6);
+	statsStop();
+
+	// Without a queue consumer the dwell histograms are left out
+	t_CANReceiver	mailboxOnly;
+	mailboxOnly.can = nullptr;
+	EXPECT_EQ(registerReceiverStats(&mailboxOnly), 4);
+	statsStop();
+}
@@ -82,4 +82,47 @@ TEST_F(InitTest, ValidFalseManualModeInitSucceeds) {
 // 	}
 // 	EXPECT_TRUE(cfg.exit);
 // 	EXPECT_TRUE(cfg.controller != nullptr);
-// }
\ No newline at end of file
+// }
+// Thread profile applies what it can and reports the rest, never fails hard
+TEST(RealTimeProfileTest, AppliesThreadProfile) {
+
+	// Test 1: Pinning to the first core and SCHED_OTHER always work
+	{
+		int result = -1;
+		cpu_set_t set;
+		std::thread worker([&result, &set]() {
+			result = applyThreadProfile("test", t_threadProfile{0, 0});
+			pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+		});
+		worker.join();
+		EXPECT_EQ(result, 1);
+		EXPECT_EQ(CPU_COUNT(&set), 1);
+		EXPECT_TRUE(CPU_ISSET(0, &set));
+	}
+
+	// Test 2: A missing core is refused and reported
+	{
+		int result = -1;
+		std::thread worker([&result]() {
+			result = applyThreadProfile("test", t_threadProfile{CPU_SETSIZE - 1, 0});
+		});
+		worker.join();
+		EXPECT_EQ(result, 0);
+	}
+
+	// Test 3: SCHED_FIFO is either granted or reported as refused
+	{
+		int result = -1;
+		int policy = -1;
+		std::thread worker([&result, &policy]() {
+			struct sched_param param;
+			result = applyThreadProfile("test", t_threadProfile{-1, 10});
+			pthread_getschedparam(pthread_self(), &policy, &param);
+		});
+		worker.join();
+		EXPECT_EQ(result == 1, policy == SCHED_FIFO);
+	}
+
+	// Test 4: Disabled profile leaves memory alone
+	EXPECT_EQ(applyProcessProfile(t_rtProfile{}), 0);
+}
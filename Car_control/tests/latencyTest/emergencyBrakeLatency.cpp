@@ -0,0 +1,167 @@
+#include "CANProtocol.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+/**
+ * @file emergencyBrakeLatency.cpp
+ * @brief Latency harness for the emergency brake TX paths.
+ *
+ * Sends emergency brakes either through the dedicated priority channel
+ * (CANProtocol::sendEmergencyBrake) or through the generic sendFrame path,
+ * optionally while the TX queue is flooded with DRIVING_COMMAND frames.
+ * The latency is measured from the call until a listener socket on the same
+ * interface sees the frame, and written as LATENCY,<us> lines compatible
+ * with latencyAverageCalculator.sh.
+ *
+ * Usage: emergencyBrakeLatency [--can=IF] [--path=priority|generic]
+ *        [--samples=N] [--load=true|false] [--log=FILE]
+ */
+
+typedef struct s_latencyConfig {
+	std::string	interface	= "vcan0";
+	std::string	path		= "priority";
+	std::string	log			= "emergencyBreakLatencyTest.log";
+	int			samples		= 100;
+	bool		load		= true;
+} t_latencyConfig;
+
+static int	parseArgs(int argc, char *argv[], t_latencyConfig *config) {
+
+	for (int i = 1; i < argc; i++) {
+
+		std::string arg(argv[i]);
+
+		if (arg.find("--can=") == 0)
+			config->interface = arg.substr(6);
+		else if (arg.find("--path=") == 0)
+			config->path = arg.substr(7);
+		else if (arg.find("--samples=") == 0)
+			config->samples = std::max(1, std::atoi(arg.substr(10).c_str()));
+		else if (arg.find("--load=") == 0)
+			config->load = (arg.substr(7) == "true");
+		else if (arg.find("--log=") == 0)
+			config->log = arg.substr(6);
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--can=IF] [--path=priority|generic]"
+					  << " [--samples=N] [--load=true|false] [--log=FILE]" << std::endl;
+			return (0);
+		}
+	}
+	if (config->path != "priority" && config->path != "generic") {
+		std::cerr << "Unknown path: " << config->path << std::endl;
+		return (0);
+	}
+	return (1);
+}
+
+// Owns the listener socket, closed on every exit path
+struct ListenerGuard {
+	int	fd;
+	~ListenerGuard() { can_close(fd); }
+};
+
+// Keeps the interface TX queue busy with regular driving commands
+// Joined on every exit path, a full TX queue (ENOBUFS) just backs off
+struct Flooder {
+	std::atomic<bool>	running;
+	std::thread			thread;
+
+	Flooder(CANController &can, bool enabled) : running(enabled) {
+		if (!enabled)
+			return ;
+		thread = std::thread([this, &can]() {
+			struct can_frame frame = {};
+			frame.can_id = CANSENDID::DRIVING_COMMAND;
+			frame.can_dlc = 2;
+			frame.data[0] = 50;
+			frame.data[1] = 60;
+			while (running.load()) {
+				if (can_send_prebuilt(can.getSocket(), &frame) < 0)
+					std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+		});
+	}
+	~Flooder() {
+		running.store(false);
+		if (thread.joinable())
+			thread.join();
+	}
+};
+
+// Discards brakes that arrived after a previous sample already timed out
+static void	drainListener(int listener) {
+
+	struct can_frame	frame;
+
+	while (can_try_receive(listener, &frame) == 0) {}
+}
+
+int	main(int argc, char *argv[]) {
+
+	t_latencyConfig	config;
+
+	if (!parseArgs(argc, argv, &config))
+		return (1);
+
+	try {
+		CANController	can(config.interface);
+
+		// Listener only sees emergency brakes, when they actually hit the bus
+		ListenerGuard listener{socketCan_open(config.interface.c_str())};
+		const uint16_t brakeId = CANSENDID::EMERGENCY_BRAKE;
+		if (listener.fd < 0 || can_set_filters(listener.fd, &brakeId, 1) < 0)
+			throw CANController::CANException("Failed to open listener socket");
+
+		FILE *log = fopen(config.log.c_str(), "a");
+		if (!log) {
+			perror("fopen");
+			return (1);
+		}
+
+		Flooder			flood(can, config.load);
+		const int8_t	data = 0xF;
+		struct can_frame	frame;
+		int				written = 0;
+		int				failed = 0;
+
+		for (int i = 0; i < config.samples; i++) {
+
+			drainListener(listener.fd);
+			try {
+				auto t_before = std::chrono::steady_clock::now();
+				if (config.path == "priority")
+					CANProtocol::sendEmergencyBrake(can, true);
+				else
+					can.sendFrame(CANSENDID::EMERGENCY_BRAKE, &data, 1);
+
+				if (can_receive_timeout(listener.fd, &frame, 1000, -1) != 0) {
+					failed++;
+					continue ;
+				}
+				auto t_after = std::chrono::steady_clock::now();
+
+				auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+					t_after - t_before).count();
+				if (fprintf(log, "LATENCY,%lld\n", (long long)latency) > 0)
+					written++;
+			} catch (const CANController::CANException&) {
+				failed++;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		fclose(log);
+		std::cout << written << "/" << config.samples << " samples (" << config.path
+				  << " path, load " << (config.load ? "on" : "off") << ") appended to "
+				  << config.log;
+		if (failed)
+			std::cout << ", " << failed << " sends failed or were not seen on the bus";
+		std::cout << std::endl;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return (1);
+	}
+	return (0);
+}
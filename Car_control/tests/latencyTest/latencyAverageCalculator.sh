@@ -1,6 +1,6 @@
 #!/bin/bash
 
-LOG_FILE="emergencyBreakLatencyTest.log"
+LOG_FILE="${1:-emergencyBreakLatencyTest.log}"
 
 # Check if log file exists
 if [ ! -f "$LOG_FILE" ]; then
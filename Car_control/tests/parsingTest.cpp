@@ -103,4 +103,118 @@ TEST(ParsingTest, ParsesUnknownOptionTriggersExit) {
 
     EXPECT_EQ(ret, 0);                    // parsing succeeded
     EXPECT_TRUE(cfg.exit);               // not an early-exit option
-}
\ No newline at end of file
+}
+// Testing if parsingArgv parses the real-time profile options
+TEST(ParsingTest, ParsesRealTimeProfile) {
+    t_carControl cfg;
+    cfg.exit = false;
+
+    char* argv[] = {
+        (char*)"prog",
+        (char*)"--rt=true",
+        (char*)"--rt-cpus=3,-1,2",
+        (char*)"--rt-prio=80,0,90"
+    };
+    int argc = 4;
+
+    int ret = parsingArgv(argc, argv, &cfg);
+
+    EXPECT_EQ(ret, 1);
+    EXPECT_TRUE(cfg.rt.enabled);
+    EXPECT_EQ(cfg.rt.control.cpu, 3);
+    EXPECT_EQ(cfg.rt.rx.cpu, -1);
+    EXPECT_EQ(cfg.rt.monitor.cpu, 2);
+    EXPECT_EQ(cfg.rt.control.priority, 80);
+    EXPECT_EQ(cfg.rt.rx.priority, 0);
+    EXPECT_EQ(cfg.rt.monitor.priority, 90);
+    EXPECT_FALSE(cfg.exit);
+}
+
+// Testing if malformed real-time lists stop the program
+TEST(ParsingTest, RejectsInvalidRealTimeLists) {
+    const char *values[] = {
+        "--rt-cpus=1,2", "--rt-cpus=1,2,3,4", "--rt-cpus=a,1,2", "--rt-cpus=1,,2",
+        "--rt-prio=100,1,1", "--rt-prio=-1,1,1"
+    };
+
+    for (const char *value : values) {
+        t_carControl cfg;
+        cfg.exit = false;
+        char* argv[] = { (char*)"prog", (char*)value };
+
+        EXPECT_EQ(parsingArgv(2, argv, &cfg), 0) << value;
+        EXPECT_TRUE(cfg.exit) << value;
+    }
+}
+
+// Testing if parsingArgv parses the reactor mode option
+TEST(ParsingTest, ParsesReactorMode) {
+    t_carControl cfg;
+    cfg.exit = false;
+
+    char* argv[] = { (char*)"prog", (char*)"--reactor=TRUE" };
+
+    EXPECT_EQ(parsingArgv(2, argv, &cfg), 1);
+    EXPECT_TRUE(cfg.reactor);
+    EXPECT_FALSE(cfg.exit);
+
+    char* bad[] = { (char*)"prog", (char*)"--reactor=maybe" };
+
+    EXPECT_EQ(parsingArgv(2, bad, &cfg), 1);
+    EXPECT_FALSE(cfg.reactor);            // invalid value falls back to default
+}
+
+// Testing if parsingArgv parses and bounds the driving command rate
+TEST(ParsingTest, ParsesDriveRate) {
+    t_carControl cfg;
+    cfg.exit = false;
+
+    char* argv[] = { (char*)"prog", (char*)"--drive-rate=100" };
+
+    EXPECT_EQ(parsingArgv(2, argv, &cfg), 1);
+    EXPECT_EQ(cfg.driveRateHz, 100);
+    EXPECT_FALSE(cfg.exit);
+
+    for (const char *value : {"--drive-rate=0", "--drive-rate=1001", "--drive-rate=fast", "--drive-rate="}) {
+        t_carControl bad;
+        bad.exit = false;
+        char* badArgv[] = { (char*)"prog", (char*)value };
+
+        EXPECT_EQ(parsingArgv(2, badArgv, &bad), 0) << value;
+        EXPECT_TRUE(bad.exit) << value;
+    }
+}
+
+TEST(ParsingTest, ParsesTxTimestamps) {
+    t_carControl cfg;
+    cfg.exit = false;
+
+    char* argv[] = { (char*)"prog", (char*)"--tx-timestamps=true" };
+
+    EXPECT_EQ(parsingArgv(2, argv, &cfg), 1);
+    EXPECT_TRUE(cfg.txTimestamps);
+    EXPECT_FALSE(cfg.exit);
+
+    char* offArgv[] = { (char*)"prog", (char*)"--tx-timestamps=false" };
+    EXPECT_EQ(parsingArgv(2, offArgv, &cfg), 1);
+    EXPECT_FALSE(cfg.txTimestamps);
+}
+
+TEST(ParsingTest, ParsesStatsSocket) {
+    t_carControl cfg;
+    cfg.exit = false;
+
+    EXPECT_EQ(cfg.statsSocket, STATS_SOCKET_PATH);
+
+    char* argv[] = { (char*)"prog", (char*)"--stats-socket=/tmp/other.stats" };
+    EXPECT_EQ(parsingArgv(2, argv, &cfg), 1);
+    EXPECT_EQ(cfg.statsSocket, "/tmp/other.stats");
+
+    char* offArgv[] = { (char*)"prog", (char*)"--stats-socket=none" };
+    EXPECT_EQ(parsingArgv(2, offArgv, &cfg), 1);
+    EXPECT_TRUE(cfg.statsSocket.empty());
+
+    char* badArgv[] = { (char*)"prog", (char*)"--stats-socket=" };
+    EXPECT_EQ(parsingArgv(2, badArgv, &cfg), 0);
+    EXPECT_TRUE(cfg.exit);
+}
@@ -3,6 +3,8 @@
 #include <thread>
 #include <vector>
 #include <chrono>
+#include <algorithm>
+#include <cstdlib>
 
 /********************************/
 /*   THREAD-SAFE UTILS TESTS    */
@@ -19,15 +21,26 @@ protected:
 
 	void TearDown() override {
 		// Clear queues
-		while (!receiver.speedQueue.empty()) {
-			receiver.speedQueue.pop();
-		}
-		while (!receiver.batteryQueue.empty()) {
-			receiver.batteryQueue.pop();
-		}
+		t_speedData		speed;
+		t_batteryData	battery;
+		while (getSpeedData(&receiver, &speed)) {}
+		while (getBatteryData(&receiver, &battery)) {}
 	}
 };
 
+// Producer helper: waits for room instead of overwriting, so tests can count every item
+template <typename Queue, typename T>
+static void	pushBlocking(Queue &queue, const T &item) {
+	while (queue.size() >= queue.capacity())
+		std::this_thread::yield();
+	queue.push(item);
+}
+
+// Benchmarks only run on request, they are too slow for single core CI runners
+#define SKIP_UNLESS_BENCHMARKS() \
+	if (!std::getenv("RUN_BENCHMARKS")) \
+		GTEST_SKIP() << "Set RUN_BENCHMARKS to run benchmarks"
+
 /********************************/
 /*   getSpeedData TESTS         */
 /********************************/
@@ -106,36 +119,31 @@ TEST_F(ThreadSafeUtilsTest, GetSpeedDataBoundaryValues) {
 	EXPECT_EQ(result.speedMps, UINT16_MAX);
 }
 
-// Test thread safety with concurrent reads
-TEST_F(ThreadSafeUtilsTest, GetSpeedDataConcurrentReads) {
-	// Push 100 elements
-	for (uint16_t i = 0; i < 100; i++) {
+// Test filling the queue up to its capacity and overflowing it
+TEST_F(ThreadSafeUtilsTest, GetSpeedDataFullQueue) {
+	const size_t capacity = receiver.speedQueue.capacity();
+	EXPECT_EQ(capacity, static_cast<size_t>(SPEED_QUEUE_SIZE));
+
+	for (uint16_t i = 0; i < capacity; i++) {
 		t_speedData data = {i, static_cast<uint16_t>(i * 2)};
 		receiver.speedQueue.push(data);
 	}
-	
-	std::atomic<int> successCount{0};
-	std::vector<std::thread> threads;
-	
-	// Create 10 threads trying to read
-	for (int i = 0; i < 10; i++) {
-		threads.emplace_back([&]() {
-			for (int j = 0; j < 10; j++) {
-				t_speedData data;
-				if (getSpeedData(&receiver, &data)) {
-					successCount++;
-				}
-			}
-		});
-	}
-	
-	for (auto& thread : threads) {
-		thread.join();
+	EXPECT_EQ(receiver.speedQueue.size(), capacity);
+
+	// Oldest sample is overwritten and counted, the newest one is kept
+	t_speedData extra = {9999, 9999};
+	receiver.speedQueue.push(extra);
+	EXPECT_EQ(receiver.speedQueue.size(), capacity);
+
+	t_speedData result;
+	for (uint16_t i = 1; i < capacity; i++) {
+		ASSERT_TRUE(getSpeedData(&receiver, &result));
+		EXPECT_EQ(result.rpm, i);
 	}
-	
-	// Exactly 100 reads should succeed
-	EXPECT_EQ(successCount.load(), 100);
-	EXPECT_TRUE(receiver.speedQueue.empty());
+	ASSERT_TRUE(getSpeedData(&receiver, &result));
+	EXPECT_EQ(result.rpm, 9999);
+	EXPECT_FALSE(getSpeedData(&receiver, &result));
+	EXPECT_EQ(receiver.speedQueue.dropped(), 1u);
 }
 
 // Test concurrent writes and reads
@@ -146,17 +154,18 @@ TEST_F(ThreadSafeUtilsTest, GetSpeedDataConcurrentWritesAndReads) {
 	// Writer thread
 	std::thread writer([&]() {
 		for (int i = 0; i < 100; i++) {
-			std::lock_guard<std::mutex> lock(receiver.speedMutex);
 			t_speedData data = {static_cast<uint16_t>(i), static_cast<uint16_t>(i * 2)};
-			receiver.speedQueue.push(data);
+			pushBlocking(receiver.speedQueue, data);
 		}
 	});
 	
 	// Reader thread
 	std::thread reader([&]() {
+		uint16_t expected = 0;
 		while (!stopReading.load() || !receiver.speedQueue.empty()) {
 			t_speedData data;
 			if (getSpeedData(&receiver, &data)) {
+				EXPECT_EQ(data.rpm, expected++);
 				readCount++;
 			}
 			std::this_thread::sleep_for(std::chrono::microseconds(10));
@@ -248,36 +257,31 @@ TEST_F(ThreadSafeUtilsTest, GetBatteryDataBoundaryValues) {
 	EXPECT_EQ(result.percentage, UINT8_MAX);
 }
 
-// Test thread safety with concurrent reads
-TEST_F(ThreadSafeUtilsTest, GetBatteryDataConcurrentReads) {
-	// Push 100 elements
-	for (uint16_t i = 0; i < 100; i++) {
-		t_batteryData data = {i, static_cast<uint8_t>(i % 101)};
+// Test filling the queue up to its capacity and overflowing it
+TEST_F(ThreadSafeUtilsTest, GetBatteryDataFullQueue) {
+	const size_t capacity = receiver.batteryQueue.capacity();
+	EXPECT_EQ(capacity, static_cast<size_t>(BATTERY_QUEUE_SIZE));
+
+	for (uint16_t i = 0; i < capacity; i++) {
+		t_batteryData data = {i, static_cast<uint8_t>(i)};
 		receiver.batteryQueue.push(data);
 	}
-	
-	std::atomic<int> successCount{0};
-	std::vector<std::thread> threads;
-	
-	// Create 10 threads trying to read
-	for (int i = 0; i < 10; i++) {
-		threads.emplace_back([&]() {
-			for (int j = 0; j < 10; j++) {
-				t_batteryData data;
-				if (getBatteryData(&receiver, &data)) {
-					successCount++;
-				}
-			}
-		});
-	}
-	
-	for (auto& thread : threads) {
-		thread.join();
+
+	// Two extra samples push out the two oldest
+	receiver.batteryQueue.push({9998, 98});
+	receiver.batteryQueue.push({9999, 99});
+
+	t_batteryData result;
+	for (uint16_t i = 2; i < capacity; i++) {
+		ASSERT_TRUE(getBatteryData(&receiver, &result));
+		EXPECT_EQ(result.voltage, i);
 	}
-	
-	// Exactly 100 reads should succeed
-	EXPECT_EQ(successCount.load(), 100);
-	EXPECT_TRUE(receiver.batteryQueue.empty());
+	ASSERT_TRUE(getBatteryData(&receiver, &result));
+	EXPECT_EQ(result.voltage, 9998);
+	ASSERT_TRUE(getBatteryData(&receiver, &result));
+	EXPECT_EQ(result.voltage, 9999);
+	EXPECT_FALSE(getBatteryData(&receiver, &result));
+	EXPECT_EQ(receiver.batteryQueue.dropped(), 2u);
 }
 
 // Test concurrent writes and reads
@@ -288,9 +292,8 @@ TEST_F(ThreadSafeUtilsTest, GetBatteryDataConcurrentWritesAndReads) {
 	// Writer thread
 	std::thread writer([&]() {
 		for (int i = 0; i < 100; i++) {
-			std::lock_guard<std::mutex> lock(receiver.batteryMutex);
 			t_batteryData data = {static_cast<uint16_t>(12000 + i), static_cast<uint8_t>(i % 101)};
-			receiver.batteryQueue.push(data);
+			pushBlocking(receiver.batteryQueue, data);
 		}
 	});
 	
@@ -340,53 +343,58 @@ TEST_F(ThreadSafeUtilsTest, IndependentQueues) {
 TEST_F(ThreadSafeUtilsTest, ConcurrentMixedOperations) {
 	std::atomic<int> speedReads{0};
 	std::atomic<int> batteryReads{0};
+	const int NUM_ITEMS = 1000;
 	
 	// Writer threads
 	std::thread speedWriter([&]() {
-		for (int i = 0; i < 50; i++) {
-			std::lock_guard<std::mutex> lock(receiver.speedMutex);
+		for (int i = 0; i < NUM_ITEMS; i++) {
 			t_speedData data = {static_cast<uint16_t>(i), static_cast<uint16_t>(i * 2)};
-			receiver.speedQueue.push(data);
+			pushBlocking(receiver.speedQueue, data);
 		}
 	});
 	
 	std::thread batteryWriter([&]() {
-		for (int i = 0; i < 50; i++) {
-			std::lock_guard<std::mutex> lock(receiver.batteryMutex);
+		for (int i = 0; i < NUM_ITEMS; i++) {
 			t_batteryData data = {static_cast<uint16_t>(12000 + i), static_cast<uint8_t>(i % 101)};
-			receiver.batteryQueue.push(data);
+			pushBlocking(receiver.batteryQueue, data);
 		}
 	});
 	
-	// Wait for writers to finish
-	speedWriter.join();
-	batteryWriter.join();
-	
-	// Reader threads
+	// Reader threads, running concurrently with the writers
 	std::thread speedReader([&]() {
 		t_speedData data;
-		while (getSpeedData(&receiver, &data)) {
-			speedReads++;
+		while (speedReads.load() < NUM_ITEMS) {
+			if (getSpeedData(&receiver, &data))
+				speedReads++;
+			else
+				std::this_thread::yield();
 		}
 	});
 	
 	std::thread batteryReader([&]() {
 		t_batteryData data;
-		while (getBatteryData(&receiver, &data)) {
-			batteryReads++;
+		while (batteryReads.load() < NUM_ITEMS) {
+			if (getBatteryData(&receiver, &data))
+				batteryReads++;
+			else
+				std::this_thread::yield();
 		}
 	});
 	
+	speedWriter.join();
+	batteryWriter.join();
 	speedReader.join();
 	batteryReader.join();
 	
-	EXPECT_EQ(speedReads.load(), 50);
-	EXPECT_EQ(batteryReads.load(), 50);
+	EXPECT_EQ(speedReads.load(), NUM_ITEMS);
+	EXPECT_EQ(batteryReads.load(), NUM_ITEMS);
 }
 
 // Test rapid alternating access
 TEST_F(ThreadSafeUtilsTest, RapidAlternatingAccess) {
-	for (int i = 0; i < 50; i++) {
+	const int items = BATTERY_QUEUE_SIZE;
+
+	for (int i = 0; i < items; i++) {
 		t_speedData speedData = {static_cast<uint16_t>(i), static_cast<uint16_t>(i * 2)};
 		t_batteryData batteryData = {static_cast<uint16_t>(12000 + i), static_cast<uint8_t>(i % 101)};
 		
@@ -395,7 +403,7 @@ TEST_F(ThreadSafeUtilsTest, RapidAlternatingAccess) {
 	}
 	
 	// Alternate between reading speed and battery
-	for (int i = 0; i < 50; i++) {
+	for (int i = 0; i < items; i++) {
 		t_speedData speed;
 		t_batteryData battery;
 		
@@ -410,76 +418,272 @@ TEST_F(ThreadSafeUtilsTest, RapidAlternatingAccess) {
 	EXPECT_TRUE(receiver.batteryQueue.empty());
 }
 
-// Stress test with many concurrent operations
+// Stress test: one producer and one consumer per queue, nothing lost or reordered
 TEST_F(ThreadSafeUtilsTest, StressTestConcurrentOperations) {
 	const int NUM_ITEMS = 1000;
-	const int NUM_THREADS = 10;
-	
-	std::atomic<int> speedWrites{0};
-	std::atomic<int> batteryWrites{0};
+
 	std::atomic<int> speedReads{0};
 	std::atomic<int> batteryReads{0};
-	
-	std::vector<std::thread> threads;
-	
-	// Speed writers
-	for (int t = 0; t < NUM_THREADS; t++) {
-		threads.emplace_back([&]() {
-			for (int i = 0; i < NUM_ITEMS / NUM_THREADS; i++) {
-				std::lock_guard<std::mutex> lock(receiver.speedMutex);
-				t_speedData data = {static_cast<uint16_t>(i), static_cast<uint16_t>(i * 2)};
-				receiver.speedQueue.push(data);
-				speedWrites++;
-			}
-		});
-	}
-	
-	// Battery writers
-	for (int t = 0; t < NUM_THREADS; t++) {
-		threads.emplace_back([&]() {
-			for (int i = 0; i < NUM_ITEMS / NUM_THREADS; i++) {
-				std::lock_guard<std::mutex> lock(receiver.batteryMutex);
-				t_batteryData data = {static_cast<uint16_t>(12000 + i), static_cast<uint8_t>(i % 101)};
-				receiver.batteryQueue.push(data);
-				batteryWrites++;
-			}
-		});
-	}
-	
-	// Wait for all writers
-	for (auto& thread : threads) {
-		thread.join();
-	}
-	threads.clear();
-	
-	// Speed readers
-	for (int t = 0; t < NUM_THREADS; t++) {
-		threads.emplace_back([&]() {
-			t_speedData data;
-			while (getSpeedData(&receiver, &data)) {
+	std::atomic<int> orderErrors{0};
+
+	std::thread speedWriter([&]() {
+		for (int i = 0; i < NUM_ITEMS; i++) {
+			t_speedData data = {static_cast<uint16_t>(i), static_cast<uint16_t>(i * 2)};
+			pushBlocking(receiver.speedQueue, data);
+		}
+	});
+
+	std::thread batteryWriter([&]() {
+		for (int i = 0; i < NUM_ITEMS; i++) {
+			t_batteryData data = {static_cast<uint16_t>(i), static_cast<uint8_t>(i)};
+			pushBlocking(receiver.batteryQueue, data);
+		}
+	});
+
+	std::thread speedReader([&]() {
+		t_speedData data;
+		while (speedReads.load() < NUM_ITEMS) {
+			if (getSpeedData(&receiver, &data)) {
+				if (data.rpm != static_cast<uint16_t>(speedReads.load()))
+					orderErrors++;
 				speedReads++;
-			}
-		});
-	}
-	
-	// Battery readers
-	for (int t = 0; t < NUM_THREADS; t++) {
-		threads.emplace_back([&]() {
-			t_batteryData data;
-			while (getBatteryData(&receiver, &data)) {
+			} else
+				std::this_thread::yield();
+		}
+	});
+
+	std::thread batteryReader([&]() {
+		t_batteryData data;
+		while (batteryReads.load() < NUM_ITEMS) {
+			if (getBatteryData(&receiver, &data)) {
+				if (data.voltage != static_cast<uint16_t>(batteryReads.load()))
+					orderErrors++;
 				batteryReads++;
-			}
-		});
-	}
-	
-	for (auto& thread : threads) {
-		thread.join();
-	}
-	
-	EXPECT_EQ(speedWrites.load(), NUM_ITEMS);
-	EXPECT_EQ(batteryWrites.load(), NUM_ITEMS);
+			} else
+				std::this_thread::yield();
+		}
+	});
+
+	speedWriter.join();
+	batteryWriter.join();
+	speedReader.join();
+	batteryReader.join();
+
 	EXPECT_EQ(speedReads.load(), NUM_ITEMS);
 	EXPECT_EQ(batteryReads.load(), NUM_ITEMS);
+	EXPECT_EQ(orderErrors.load(), 0);
 	EXPECT_TRUE(receiver.speedQueue.empty());
 	EXPECT_TRUE(receiver.batteryQueue.empty());
 }
+
+// Producer never waits: a slow consumer only sees newer samples, in order, and counts the rest
+TEST_F(ThreadSafeUtilsTest, OverwritingProducerKeepsNewestInOrder) {
+	const int NUM_ITEMS = 1000;
+
+	std::atomic<bool> done{false};
+	int reads = 0;
+	int orderErrors = 0;
+
+	std::thread writer([&]() {
+		for (int i = 0; i < NUM_ITEMS; i++) {
+			t_speedData data = {static_cast<uint16_t>(i), 0};
+			receiver.speedQueue.push(data);
+		}
+		done.store(true);
+	});
+
+	t_speedData data;
+	int last = -1;
+	while (!done.load() || !receiver.speedQueue.empty()) {
+		if (getSpeedData(&receiver, &data)) {
+			if (data.rpm <= last)
+				orderErrors++;
+			last = data.rpm;
+			reads++;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(10));
+	}
+	writer.join();
+
+	EXPECT_EQ(orderErrors, 0);
+	EXPECT_EQ(last, NUM_ITEMS - 1);
+	EXPECT_EQ(reads + static_cast<int>(receiver.speedQueue.dropped()), NUM_ITEMS);
+}
+
+/********************************/
+/*   LATEST VALUE MAILBOX TESTS */
+/********************************/
+
+// Nothing published yet
+TEST_F(ThreadSafeUtilsTest, GetLatestSpeedEmpty) {
+	t_speedSample	sample;
+	uint64_t		lastSequence = 0;
+
+	EXPECT_FALSE(getLatestSpeed(&receiver, &sample, &lastSequence));
+	EXPECT_EQ(lastSequence, 0u);
+}
+
+// Only the newest sample is returned, and only once
+TEST_F(ThreadSafeUtilsTest, GetLatestSpeedReturnsNewest) {
+	t_speedSample	sample;
+	uint64_t		lastSequence = 0;
+
+	receiver.speedMailbox.publish({1000, 50}, 10);
+	receiver.speedMailbox.publish({2000, 100}, 20);
+	receiver.speedMailbox.publish({3000, 150}, 30);
+
+	ASSERT_TRUE(getLatestSpeed(&receiver, &sample, &lastSequence));
+	EXPECT_EQ(sample.value.rpm, 3000);
+	EXPECT_EQ(sample.value.speedMps, 150);
+	EXPECT_EQ(sample.timestampNs, 30);
+	EXPECT_EQ(sample.sequence, 3u);
+	EXPECT_EQ(lastSequence, 3u);
+
+	// Already seen
+	EXPECT_FALSE(getLatestSpeed(&receiver, &sample, &lastSequence));
+}
+
+// Readers can tell how many updates they skipped
+TEST_F(ThreadSafeUtilsTest, GetLatestBatteryReportsSkipped) {
+	t_batterySample	sample;
+	uint64_t		lastSequence = 0;
+
+	receiver.batteryMailbox.publish({12000, 50}, 1);
+	ASSERT_TRUE(getLatestBattery(&receiver, &sample, &lastSequence));
+	EXPECT_EQ(sample.sequence, 1u);
+
+	const uint64_t previous = lastSequence;
+	for (uint16_t i = 0; i < 5; i++)
+		receiver.batteryMailbox.publish({static_cast<uint16_t>(12100 + i), 60}, 2 + i);
+
+	ASSERT_TRUE(getLatestBattery(&receiver, &sample, &lastSequence));
+	EXPECT_EQ(sample.value.voltage, 12104);
+	EXPECT_EQ(sample.sequence - previous - 1, 4u);
+}
+
+// Concurrent reader never sees a torn sample, and sequences only move forward
+TEST_F(ThreadSafeUtilsTest, GetLatestSpeedConcurrentConsistency) {
+	const int NUM_ITEMS = 1000;
+
+	std::atomic<bool> done{false};
+	int tornReads = 0;
+	int orderErrors = 0;
+
+	std::thread writer([&]() {
+		for (int i = 1; i <= NUM_ITEMS; i++) {
+			t_speedData data = {static_cast<uint16_t>(i), static_cast<uint16_t>(i * 2)};
+			receiver.speedMailbox.publish(data, i);
+		}
+		done.store(true);
+	});
+
+	t_speedSample	sample;
+	uint64_t		lastSequence = 0;
+	while (!done.load() || lastSequence < static_cast<uint64_t>(NUM_ITEMS)) {
+		const uint64_t previous = lastSequence;
+		if (getLatestSpeed(&receiver, &sample, &lastSequence)) {
+			if (sample.value.speedMps != static_cast<uint16_t>(sample.value.rpm * 2)
+				|| sample.timestampNs != sample.value.rpm
+				|| sample.sequence != sample.value.rpm)
+				tornReads++;
+			if (sample.sequence <= previous)
+				orderErrors++;
+		} else
+			std::this_thread::yield();
+	}
+	writer.join();
+
+	EXPECT_EQ(tornReads, 0);
+	EXPECT_EQ(orderErrors, 0);
+	EXPECT_EQ(lastSequence, static_cast<uint64_t>(NUM_ITEMS));
+}
+
+/********************************/
+/*   BENCHMARKS                 */
+/********************************/
+
+// Throughput of the speed queue with the producer and consumer on two threads
+TEST_F(ThreadSafeUtilsTest, BenchmarkSpeedQueueThroughput) {
+	SKIP_UNLESS_BENCHMARKS();
+
+	const int NUM_ITEMS = 1000;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::thread writer([&]() {
+		for (int i = 0; i < NUM_ITEMS; i++) {
+			t_speedData data = {static_cast<uint16_t>(i), 0};
+			pushBlocking(receiver.speedQueue, data);
+		}
+	});
+
+	int reads = 0;
+	t_speedData data;
+	while (reads < NUM_ITEMS) {
+		if (getSpeedData(&receiver, &data))
+			reads++;
+		else
+			std::this_thread::yield();
+	}
+	writer.join();
+
+	auto elapsed = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+	double itemsPerSec = NUM_ITEMS / elapsed;
+
+	std::cout << "[BENCH] speed queue throughput: " << itemsPerSec / 1e6
+			  << " M items/s" << std::endl;
+	RecordProperty("items_per_sec", std::to_string(static_cast<long long>(itemsPerSec)));
+	EXPECT_EQ(reads, NUM_ITEMS);
+}
+
+// Push-to-pop latency of the speed queue with a spinning consumer
+TEST_F(ThreadSafeUtilsTest, BenchmarkSpeedQueueLatency) {
+	SKIP_UNLESS_BENCHMARKS();
+
+	const int SAMPLES = 10000;
+
+	std::vector<int64_t> latencies;
+	latencies.reserve(SAMPLES);
+	std::atomic<bool> ready{false};
+
+	// Consumer records the time between the producer's push and its pop
+	std::vector<std::chrono::steady_clock::time_point> pushed(SAMPLES);
+	std::thread reader([&]() {
+		t_speedData data;
+		ready.store(true);
+		for (int i = 0; i < SAMPLES; ) {
+			if (getSpeedData(&receiver, &data)) {
+				auto now = std::chrono::steady_clock::now();
+				latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					now - pushed[data.rpm]).count());
+				i++;
+			} else
+				std::this_thread::yield();
+		}
+	});
+
+	while (!ready.load())
+		std::this_thread::yield();
+
+	for (int i = 0; i < SAMPLES; i++) {
+		pushed[i] = std::chrono::steady_clock::now();
+		t_speedData data = {static_cast<uint16_t>(i), 0};
+		pushBlocking(receiver.speedQueue, data);
+
+		// Space samples so the queue is measured empty, not saturated
+		auto until = pushed[i] + std::chrono::microseconds(2);
+		while (std::chrono::steady_clock::now() < until) {}
+	}
+	reader.join();
+
+	std::sort(latencies.begin(), latencies.end());
+	int64_t p50 = latencies[SAMPLES / 2];
+	int64_t p99 = latencies[(SAMPLES * 99) / 100];
+
+	std::cout << "[BENCH] speed queue latency: p50 = " << p50 << " ns, p99 = "
+			  << p99 << " ns" << std::endl;
+	RecordProperty("latency_p50_ns", std::to_string(p50));
+	RecordProperty("latency_p99_ns", std::to_string(p99));
+	EXPECT_EQ(latencies.size(), static_cast<size_t>(SAMPLES));
+}
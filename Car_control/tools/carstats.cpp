@@ -0,0 +1,75 @@
+#include "StatsServer.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/**
+ * @file carstats.cpp
+ * @brief Queries the stats endpoint of a running car process.
+ *
+ * Sends the command given on the command line (default "show") to the
+ * Unix socket opened by car --stats-socket and prints the response.
+ *
+ * Usage: carstats [--socket=PATH] [list | show [PREFIX] | dump NAME | help]
+ */
+
+int	main(int argc, char *argv[]) {
+
+	std::string	path = STATS_SOCKET_PATH;
+	std::string	command;
+
+	for (int i = 1; i < argc; i++) {
+		std::string	arg(argv[i]);
+		if (arg.find("--socket=") == 0)
+			path = arg.substr(9);
+		else if (arg == "--help" || arg == "-h") {
+			std::cout << "Usage: " << argv[0]
+					  << " [--socket=PATH] [list | show [PREFIX] | dump NAME | help]\n"
+					  << "  --socket=PATH     Endpoint of the car process (default: "
+					  << STATS_SOCKET_PATH << ")" << std::endl;
+			return (0);
+		} else
+			command += (command.empty() ? "" : " ") + arg;
+	}
+	if (command.empty())
+		command = "show";
+
+	struct sockaddr_un	addr = {};
+	int					fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (fd < 0 || path.size() >= sizeof(addr.sun_path)) {
+		std::cerr << "Invalid socket " << path << std::endl;
+		return (1);
+	}
+	addr.sun_family = AF_UNIX;
+	std::strcpy(addr.sun_path, path.c_str());
+	if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+		std::cerr << "Cannot reach " << path << ": " << strerror(errno)
+				  << " (is car running with the stats endpoint?)" << std::endl;
+		close(fd);
+		return (1);
+	}
+
+	command += '\n';
+	if (send(fd, command.data(), command.size(), MSG_NOSIGNAL)
+		!= static_cast<ssize_t>(command.size())) {
+		perror("send");
+		close(fd);
+		return (1);
+	}
+	shutdown(fd, SHUT_WR);
+
+	// The server closes the connection after its response
+	char	buf[4096];
+	ssize_t	n;
+	while ((n = read(fd, buf, sizeof(buf))) > 0)
+		fwrite(buf, 1, static_cast<size_t>(n), stdout);
+	close(fd);
+	return (n < 0 ? 1 : 0);
+}
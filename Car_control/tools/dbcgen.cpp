@@ -0,0 +1,329 @@
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @file dbcgen.cpp
+ * @brief Build-time generator of CAN message definitions from a DBC file.
+ *
+ * Reads the messages (BO_), signals (SG_) and message comments (CM_ BO_)
+ * of a DBC file and writes a header of constexpr CANSignal descriptions,
+ * pack/unpack functions and the receive dispatch registration of one node.
+ * Multiplexed signals and extended IDs are not supported.
+ *
+ * Usage: dbcgen <input.dbc> <output.hpp> <node>
+ */
+
+typedef struct s_ratio {
+	int64_t	num;
+	int64_t	den;
+} t_ratio;
+
+typedef struct s_signal {
+	std::string	name;
+	unsigned	startBit;
+	unsigned	length;
+	bool		bigEndian;
+	bool		isSigned;
+	t_ratio		factor;
+	t_ratio		offset;
+	double		min;
+	double		max;
+	std::string	unit;
+	std::vector<std::string>	receivers;
+} t_signal;
+
+typedef struct s_message {
+	uint32_t	id;
+	std::string	name;
+	unsigned	dlc;
+	std::string	transmitter;
+	std::string	comment;
+	std::vector<t_signal>	signals;
+} t_message;
+
+// Exact conversion of a DBC decimal ("0.125", "-40") to a reduced fraction
+static bool	parseDecimal(const std::string &text, t_ratio *out) {
+
+	static const std::regex	decimal(R"(^\s*([+-]?)(\d+)(?:\.(\d+))?\s*$)");
+	std::smatch				m;
+
+	if (!std::regex_match(text, m, decimal) || m[2].length() + m[3].length() > 18)
+		return (false);
+
+	int64_t	num = std::stoll(m[2].str() + m[3].str());
+	int64_t	den = 1;
+	for (size_t i = 0; i < static_cast<size_t>(m[3].length()); i++)
+		den *= 10;
+	if (m[1] == "-")
+		num = -num;
+
+	int64_t	g = std::gcd(num, den);
+	out->num = num / g;
+	out->den = den / g;
+	return (true);
+}
+
+static std::vector<std::string>	splitReceivers(const std::string &text) {
+
+	std::vector<std::string>	nodes;
+	std::stringstream			ss(text);
+	std::string					node;
+
+	while (std::getline(ss, node, ',')) {
+		node.erase(0, node.find_first_not_of(" \t\r"));
+		node.erase(node.find_last_not_of(" \t\r") + 1);
+		if (!node.empty())
+			nodes.push_back(node);
+	}
+	return (nodes);
+}
+
+static int	parseDbc(std::istream &in, std::vector<t_message> *messages) {
+
+	static const std::regex	bo(R"(^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+))");
+	static const std::regex	sg(R"re(^\s+SG_\s+(\w+)\s*(\S*)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*)re"
+		R"re(\(([^,]+),([^)]+)\)\s*\[([^|]*)\|([^\]]*)\]\s*"([^"]*)"\s*(.*)$)re");
+	static const std::regex	cm(R"re(^CM_\s+BO_\s+(\d+)\s+"([^"]*)"\s*;)re");
+	std::string				line;
+	std::smatch				m;
+	int						lineNumber = 0;
+
+	while (std::getline(in, line)) {
+		lineNumber++;
+
+		if (std::regex_search(line, m, bo)) {
+			t_message	message;
+			message.id = static_cast<uint32_t>(std::stoul(m[1]));
+			message.name = m[2];
+			message.dlc = static_cast<unsigned>(std::stoul(m[3]));
+			message.transmitter = m[4];
+			if (message.id > 0x7FF || message.dlc > 8) {
+				std::cerr << "line " << lineNumber << ": " << message.name
+						  << " must be a standard ID with at most 8 bytes" << std::endl;
+				return (-1);
+			}
+			messages->push_back(message);
+		}
+		else if (std::regex_search(line, m, sg)) {
+			if (messages->empty() || !m[2].str().empty()) {
+				std::cerr << "line " << lineNumber << ": signal outside of a message"
+						  << " or multiplexed signal" << std::endl;
+				return (-1);
+			}
+			t_signal	signal;
+			signal.name = m[1];
+			signal.startBit = static_cast<unsigned>(std::stoul(m[3]));
+			signal.length = static_cast<unsigned>(std::stoul(m[4]));
+			signal.bigEndian = (m[5] == "0");
+			signal.isSigned = (m[6] == "-");
+			signal.min = std::stod(m[9]);
+			signal.max = std::stod(m[10]);
+			signal.unit = m[11];
+			signal.receivers = splitReceivers(m[12]);
+			if (!parseDecimal(m[7], &signal.factor) || !parseDecimal(m[8], &signal.offset)
+				|| signal.factor.num == 0) {
+				std::cerr << "line " << lineNumber << ": unsupported factor or offset for "
+						  << signal.name << std::endl;
+				return (-1);
+			}
+			messages->back().signals.push_back(signal);
+		}
+		else if (std::regex_search(line, m, cm)) {
+			for (t_message &message : *messages) {
+				if (message.id == std::stoul(m[1]))
+					message.comment = m[2];
+			}
+		}
+	}
+	return (0);
+}
+
+// Smallest standard type holding every physical value of the signal
+static std::string	physicalType(const t_signal &signal) {
+
+	if (signal.factor.den != 1 || signal.offset.den != 1)
+		return ("float");
+
+	long double	rawMin = signal.isSigned ? -std::ldexp(1.0L, signal.length - 1) : 0;
+	long double	rawMax = signal.isSigned ? std::ldexp(1.0L, signal.length - 1) - 1
+		: std::ldexp(1.0L, signal.length) - 1;
+	long double	a = rawMin * signal.factor.num + signal.offset.num;
+	long double	b = rawMax * signal.factor.num + signal.offset.num;
+	long double	lo = std::min(a, b);
+	long double	hi = std::max(a, b);
+
+	const char	*prefix = lo < 0 ? "int" : "uint";
+	for (int bits = 8; bits <= 64; bits *= 2) {
+		long double limit = lo < 0 ? std::ldexp(1.0L, bits - 1) : std::ldexp(1.0L, bits);
+		if (hi < limit && (lo >= 0 || -lo <= limit))
+			return (std::string(prefix) + std::to_string(bits) + "_t");
+	}
+	return (lo < 0 ? "int64_t" : "uint64_t");
+}
+
+static std::string	ratioType(const t_ratio &r) {
+
+	if (r.den == 1)
+		return ("std::ratio<" + std::to_string(r.num) + ">");
+	return ("std::ratio<" + std::to_string(r.num) + ", " + std::to_string(r.den) + ">");
+}
+
+static bool	isReceivedBy(const t_message &message, const std::string &node) {
+
+	if (message.transmitter == node)
+		return (false);
+	for (const t_signal &signal : message.signals) {
+		for (const std::string &receiver : signal.receivers) {
+			if (receiver == node)
+				return (true);
+		}
+	}
+	return (false);
+}
+
+static std::string	hexId(uint32_t id) {
+
+	std::stringstream	ss;
+	ss << "0x" << std::hex << std::uppercase << id;
+	return (ss.str());
+}
+
+static void	writeMessage(std::ostream &out, const t_message &message, bool received) {
+
+	out << "\t/** " << (message.comment.empty() ? message.name : message.comment)
+		<< " (sent by " << message.transmitter << ") */\n"
+		<< "\tnamespace " << message.name << " {\n"
+		<< "\t\tconstexpr uint16_t\tID\t= " << hexId(message.id) << ";\n"
+		<< "\t\tconstexpr uint8_t\tDLC\t= " << message.dlc << ";\n\n";
+
+	for (const t_signal &signal : message.signals) {
+		out << "\t\ttypedef CANSignal<" << physicalType(signal) << ", " << signal.startBit
+			<< ", " << signal.length << ", ByteOrder::"
+			<< (signal.bigEndian ? "BigEndian" : "LittleEndian") << ", "
+			<< ratioType(signal.factor) << ", " << ratioType(signal.offset) << ">\t"
+			<< signal.name << ";";
+		out << "\t/**< " << signal.min << ".." << signal.max;
+		if (!signal.unit.empty())
+			out << " " << signal.unit;
+		out << " */\n";
+	}
+
+	// Layout check
+	out << "\n\t\tstatic_assert(validLayout<DLC";
+	for (const t_signal &signal : message.signals)
+		out << ", " << signal.name;
+	out << ">(), \"" << message.name << " layout\");\n\n";
+
+	// Decoded message
+	out << "\t\t/** @brief Physical values of every signal */\n"
+		<< "\t\tstruct Values {\n";
+	for (const t_signal &signal : message.signals)
+		out << "\t\t\t" << physicalType(signal) << "\t" << signal.name << ";\n";
+	out << "\t\t};\n\n";
+
+	out << "\t\t/** @brief Decodes every signal of the payload */\n"
+		<< "\t\tconstexpr Values\tunpack(const uint8_t (&data)[8]) {\n"
+		<< "\t\t\tValues values{};\n";
+	for (const t_signal &signal : message.signals)
+		out << "\t\t\tvalues." << signal.name << " = " << signal.name << "::decode(data);\n";
+	out << "\t\t\treturn (values);\n"
+		<< "\t\t}\n\n";
+
+	out << "\t\t/** @brief Encodes every signal into the payload */\n"
+		<< "\t\tconstexpr void\tpack(uint8_t (&data)[8], const Values &values) {\n";
+	for (const t_signal &signal : message.signals)
+		out << "\t\t\t" << signal.name << "::encode(data, values." << signal.name << ");\n";
+	out << "\t\t}\n";
+
+	if (received)
+		out << "\n\t\t/** @brief Receive handler, defined by the application */\n"
+			<< "\t\tvoid\tonFrame(const struct can_frame &frame, int64_t timestampNs, void *ctx);\n";
+	out << "\t}\n\n";
+}
+
+static void	writeHeader(std::ostream &out, const std::vector<t_message> &messages,
+				const std::string &source, const std::string &node) {
+
+	std::vector<const t_message*>	received;
+	std::vector<const t_message*>	sent;
+
+	for (const t_message &message : messages) {
+		if (isReceivedBy(message, node))
+			received.push_back(&message);
+		if (message.transmitter == node)
+			sent.push_back(&message);
+	}
+
+	out << "#pragma once\n\n"
+		<< "// Generated by dbcgen from " << source << ", do not edit.\n\n"
+		<< "#include \"CANSignal.hpp\"\n"
+		<< "#include \"CANDispatcher.hpp\"\n\n"
+		<< "/**\n"
+		<< " * @file CANMessages.hpp\n"
+		<< " * @brief CAN messages of the vehicle bus, as seen by " << node << ".\n"
+		<< " */\n\n"
+		<< "namespace CANMSG {\n\n";
+
+	for (const t_message &message : messages)
+		writeMessage(out, message, isReceivedBy(message, node));
+
+	out << "\t/** Number of messages sent by " << node << " */\n"
+		<< "\tconstexpr size_t\tTX_COUNT = " << sent.size() << ";\n\n"
+		<< "\t/** IDs sent by " << node << " */\n"
+		<< "\tconstexpr uint16_t\tTX_IDS[" << (sent.empty() ? 1 : sent.size()) << "] = {";
+	for (size_t i = 0; i < sent.size(); i++)
+		out << (i ? ", " : "") << sent[i]->name << "::ID";
+	out << "};\n\n";
+
+	out << "\t/** Number of messages received by " << node << " */\n"
+		<< "\tconstexpr size_t\tRX_COUNT = " << received.size() << ";\n\n"
+		<< "\t/**\n"
+		<< "\t * @brief Registers the onFrame() handler of every message received by " << node << "\n"
+		<< "\t *\n"
+		<< "\t * @param dispatcher Dispatcher to fill\n"
+		<< "\t * @param ctx Pointer passed back to every handler\n"
+		<< "\t * @return 0 if successful, -1 if a registration failed\n"
+		<< "\t */\n"
+		<< "\tinline int\tregisterRxHandlers(CANDispatcher &dispatcher, void *ctx) {\n\n";
+	for (const t_message *message : received)
+		out << "\t\tif (dispatcher.registerHandler(" << message->name << "::ID, "
+			<< message->name << "::onFrame, ctx) < 0)\n"
+			<< "\t\t\treturn (-1);\n";
+	out << "\t\treturn (0);\n"
+		<< "\t}\n"
+		<< "}\n";
+}
+
+int	main(int argc, char *argv[]) {
+
+	std::vector<t_message>	messages;
+
+	if (argc != 4) {
+		std::cerr << "Usage: " << argv[0] << " <input.dbc> <output.hpp> <node>" << std::endl;
+		return (1);
+	}
+
+	std::ifstream	in(argv[1]);
+	if (!in) {
+		std::cerr << "Cannot open " << argv[1] << std::endl;
+		return (1);
+	}
+	if (parseDbc(in, &messages) < 0)
+		return (1);
+
+	std::string		source(argv[1]);
+	std::ofstream	out(argv[2]);
+	if (!out) {
+		std::cerr << "Cannot write " << argv[2] << std::endl;
+		return (1);
+	}
+	writeHeader(out, messages, source.substr(source.find_last_of('/') + 1), argv[3]);
+	return (out.good() ? 0 : 1);
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @file tracereport.cpp
+ * @brief Latency report of a tracepoint dump (car --trace=FILE).
+ *
+ * Pairs the stages of every chain (evdev -> decode -> can_write) and every
+ * CAN write with the next TX echo of the same ID, then prints count, min,
+ * p50, p99, p99.9 and max of each stage pair with a log2 histogram.
+ *
+ * Usage: tracereport <trace.csv>
+ */
+
+enum e_stage {
+	STAGE_EVDEV,
+	STAGE_DECODE,
+	STAGE_CAN_WRITE,
+	STAGE_TX_CONFIRM,
+	STAGE_COUNT
+};
+
+static const char	*g_stages[STAGE_COUNT] = {"evdev", "decode", "can_write", "tx_confirm"};
+
+typedef struct s_chain {
+	int64_t	at[STAGE_COUNT] = {0, 0, 0, 0};		/**< First hit of each stage, 0 if none */
+} t_chain;
+
+typedef struct s_pair {
+	const char				*name;
+	std::vector<int64_t>	deltasNs;
+} t_pair;
+
+static int	stageIndex(const std::string &name) {
+
+	for (int i = 0; i < STAGE_COUNT; i++) {
+		if (name == g_stages[i])
+			return (i);
+	}
+	return (-1);
+}
+
+static int64_t	percentile(const std::vector<int64_t> &sorted, double p) {
+
+	size_t	rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+	return (sorted[rank ? rank - 1 : 0]);
+}
+
+static void	printPair(t_pair &pair) {
+
+	std::vector<int64_t>	&d = pair.deltasNs;
+
+	if (d.empty()) {
+		printf("%-22s no samples\n\n", pair.name);
+		return ;
+	}
+	std::sort(d.begin(), d.end());
+	printf("%-22s n=%zu  min %.1f  p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f us\n",
+		pair.name, d.size(), d.front() / 1e3, percentile(d, 50) / 1e3,
+		percentile(d, 99) / 1e3, percentile(d, 99.9) / 1e3, d.back() / 1e3);
+
+	// Buckets [2^k, 2^(k+1)) microseconds, bucket 0 holds everything below 1 us
+	std::map<int, size_t>	buckets;
+	for (int64_t ns : d) {
+		int64_t	us = ns / 1000;
+		int		k = us <= 0 ? 0 : 1 + static_cast<int>(std::log2(static_cast<double>(us)));
+		buckets[k]++;
+	}
+	size_t	peak = 0;
+	for (const auto &b : buckets)
+		peak = std::max(peak, b.second);
+	for (const auto &b : buckets) {
+		long	low = b.first == 0 ? 0 : 1L << (b.first - 1);
+		int		bar = static_cast<int>(50.0 * b.second / peak + 0.5);
+		printf("  %8ld us | %-50s %zu\n", low, std::string(bar, '#').c_str(), b.second);
+	}
+	printf("\n");
+}
+
+int	main(int argc, char *argv[]) {
+
+	if (argc != 2) {
+		std::cerr << "Usage: " << argv[0] << " <trace.csv>" << std::endl;
+		return (1);
+	}
+
+	std::ifstream	in(argv[1]);
+	if (!in) {
+		std::cerr << "Cannot open " << argv[1] << std::endl;
+		return (1);
+	}
+
+	std::map<uint32_t, t_chain>							chains;
+	std::map<uint32_t, std::vector<int64_t>>			writes;		// per CAN ID
+	std::map<uint32_t, std::vector<int64_t>>			confirms;	// per CAN ID
+	std::string	line;
+	size_t		records = 0;
+
+	std::getline(in, line);	// header
+	while (std::getline(in, line)) {
+		std::stringstream	ss(line);
+		std::string			thread, stage, id, chain, time;
+
+		if (!std::getline(ss, thread, ',') || !std::getline(ss, stage, ',')
+			|| !std::getline(ss, id, ',') || !std::getline(ss, chain, ',')
+			|| !std::getline(ss, time, ','))
+			continue ;
+
+		int			s = stageIndex(stage);
+		uint32_t	canId = static_cast<uint32_t>(std::stoul(id, nullptr, 16));
+		uint32_t	c = static_cast<uint32_t>(std::stoul(chain));
+		int64_t		t = std::stoll(time);
+
+		if (s < 0)
+			continue ;
+		records++;
+		if (c != 0 && chains[c].at[s] == 0)
+			chains[c].at[s] = t;
+		if (s == STAGE_CAN_WRITE)
+			writes[canId].push_back(t);
+		else if (s == STAGE_TX_CONFIRM)
+			confirms[canId].push_back(t);
+	}
+
+	t_pair	pairs[] = {
+		{"evdev -> decode", {}},
+		{"decode -> can_write", {}},
+		{"evdev -> can_write", {}},
+		{"can_write -> tx_confirm", {}},
+	};
+
+	for (const auto &entry : chains) {
+		const int64_t	*at = entry.second.at;
+		if (at[STAGE_EVDEV] && at[STAGE_DECODE])
+			pairs[0].deltasNs.push_back(at[STAGE_DECODE] - at[STAGE_EVDEV]);
+		if (at[STAGE_DECODE] && at[STAGE_CAN_WRITE])
+			pairs[1].deltasNs.push_back(at[STAGE_CAN_WRITE] - at[STAGE_DECODE]);
+		if (at[STAGE_EVDEV] && at[STAGE_CAN_WRITE])
+			pairs[2].deltasNs.push_back(at[STAGE_CAN_WRITE] - at[STAGE_EVDEV]);
+	}
+
+	// Each echo belongs to the latest write of its ID that precedes it
+	for (auto &entry : confirms) {
+		std::vector<int64_t>	&w = writes[entry.first];
+		std::sort(w.begin(), w.end());
+		std::sort(entry.second.begin(), entry.second.end());
+		size_t	next = 0;
+		for (int64_t t : entry.second) {
+			while (next < w.size() && w[next] <= t)
+				next++;
+			if (next > 0)
+				pairs[3].deltasNs.push_back(t - w[next - 1]);
+		}
+	}
+
+	printf("%zu records, %zu chains\n\n", records, chains.size());
+	for (t_pair &pair : pairs)
+		printPair(pair);
+	return (0);
+}
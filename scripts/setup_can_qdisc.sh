@@ -0,0 +1,19 @@
+#!/bin/bash
+
+# SO_PRIORITY is only honoured by a priority aware qdisc. Raspberry Pi OS
+# attaches fq_codel by default, which ignores it, so emergency brakes would
+# queue behind driving commands. pfifo_fast maps priority 6 to its first band.
+# Must be run again whenever the interface is recreated.
+
+set -e
+
+IFACE="${1:-can0}"
+
+echo "Current qdisc on $IFACE:"
+tc qdisc show dev "$IFACE"
+
+echo "Switching $IFACE root qdisc to pfifo_fast..."
+sudo tc qdisc replace dev "$IFACE" root pfifo_fast
+
+tc qdisc show dev "$IFACE"
+echo "Done! SO_PRIORITY is now honoured on $IFACE."